@@ -32,3 +32,9 @@ CONFIG(with_tools) {
     SUBDIRS += MEGASync/mega/contrib/QtCreator/MEGACli
     SUBDIRS += MEGASync/mega/contrib/QtCreator/MEGASimplesync
 }
+
+# qmake "CONFIG+=with_tests" MEGA.pro && make && make check
+# Benchmarks are built too, but they are run manually
+CONFIG(with_tests) {
+    SUBDIRS += MEGATests
+}
@@ -5,6 +5,9 @@
 #include "control/Utilities.h"
 #include "control/CrashHandler.h"
 #include "control/ExportProcessor.h"
+#include "control/PublicNodeCache.h"
+#include "control/StartupProfiler.h"
+#include "control/StateCacheVerifier.h"
 #include "platform/Platform.h"
 #include "qtlockedfile/qtlockedfile.h"
 
@@ -105,7 +108,9 @@ int main(int argc, char *argv[])
 #ifdef Q_OS_LINUX
     QApplication::setDesktopSettingsAware(false);
 #endif
+    StartupProfiler::instance()->begin(QString::fromUtf8("qApplication"));
     MegaApplication app(argc, argv);
+    StartupProfiler::instance()->end(QString::fromUtf8("qApplication"));
 
     qInstallMsgHandler(msgHandler);
 #if QT_VERSION >= 0x050000
@@ -134,10 +139,13 @@ int main(int argc, char *argv[])
     }
 
 #ifndef DEBUG
+    StartupProfiler::instance()->begin(QString::fromUtf8("crashHandler"));
     CrashHandler::instance()->Init(QDir::toNativeSeparators(crashPath));
+    StartupProfiler::instance()->end(QString::fromUtf8("crashHandler"));
 #endif
     if ((argc == 2) && !strcmp("/uninstall", argv[1]))
     {
+        StartupProfiler::instance()->begin(QString::fromUtf8("uninstall"));
         Preferences *preferences = Preferences::instance();
         preferences->initialize();
         if (!preferences->error())
@@ -188,7 +196,8 @@ int main(int argc, char *argv[])
             const QFileInfo& fi = di.fileInfo();
             if (fi.fileName().endsWith(QString::fromAscii(".db"))
                     || !fi.fileName().compare(QString::fromUtf8("MEGAsync.cfg"))
-                    || !fi.fileName().compare(QString::fromUtf8("MEGAsync.cfg.bak")))
+                    || !fi.fileName().compare(QString::fromUtf8("MEGAsync.cfg.bak"))
+                    || !fi.fileName().compare(EncryptedSettings::blobFileName(QString::fromUtf8("MEGAsync.cfg"))))
             {
                 QFile::remove(di.filePath());
             }
@@ -218,6 +227,8 @@ int main(int argc, char *argv[])
             Sleep(5000);
         }
 #endif
+        StartupProfiler::instance()->end(QString::fromUtf8("uninstall"));
+        StartupProfiler::instance()->finish();
         return 0;
     }
 
@@ -373,11 +384,10 @@ MegaApplication::MegaApplication(int &argc, char **argv) :
         currentDir.mkpath(QString::fromAscii("."));
     }
     QDir::setCurrent(dataPath);
+    DebrisTracker::instance()->load(dataPath + QString::fromAscii("/debris.dat"));
 
     updateAvailable = false;
     networkConnectivity = true;
-    lastStartedDownload = 0;
-    lastStartedUpload = 0;
     trayIcon = NULL;
     trayMenu = NULL;
     trayOverQuotaMenu = NULL;
@@ -385,9 +395,15 @@ MegaApplication::MegaApplication(int &argc, char **argv) :
     megaApi = NULL;
     delegateListener = NULL;
     httpServer = NULL;
-    totalDownloadSize = totalUploadSize = 0;
-    totalDownloadedSize = totalUploadedSize = 0;
-    uploadSpeed = downloadSpeed = 0;
+    transferStatistics = NULL;
+    nodeUpdateProcessor = NULL;
+    exclusionEvaluator = NULL;
+    exclusionUploader = NULL;
+    syncResumer = NULL;
+    debrisRetentionTask = new DebrisRetentionTask(this);
+    lastDebrisRetention = 0;
+    measuredUploadRate = 0;
+    trayTooltipShowsEta = false;
     exportOps = 0;
     infoDialog = NULL;
     infoOverQuota = NULL;
@@ -454,6 +470,8 @@ void MegaApplication::initialize()
         return;
     }
 
+    StartupPhase startupPhase("initialize");
+
     paused = false;
     indexing = false;
     setQuitOnLastWindowClosed(false);
@@ -475,6 +493,7 @@ void MegaApplication::initialize()
     preferences = Preferences::instance();
     connect(preferences, SIGNAL(stateChanged()), this, SLOT(changeState()));
     connect(preferences, SIGNAL(updated()), this, SLOT(showUpdatedMessage()));
+    StartupProfiler::instance()->begin(QString::fromUtf8("preferences"));
     preferences->initialize();
     if (preferences->error())
     {
@@ -483,6 +502,7 @@ void MegaApplication::initialize()
 
     preferences->setLastStatsRequest(0);
     lastExit = preferences->getLastExit();
+    StartupProfiler::instance()->end(QString::fromUtf8("preferences"));
 
     QString basePath = QDir::toNativeSeparators(QDir::currentPath()+QString::fromAscii("/"));
 
@@ -500,6 +520,7 @@ void MegaApplication::initialize()
     }
 #endif
 
+    StartupProfiler::instance()->begin(QString::fromUtf8("megaApi"));
 #ifndef __APPLE__
     megaApi = new MegaApi(Preferences::CLIENT_KEY, basePath.toUtf8().constData(), Preferences::USER_AGENT);
 #else
@@ -513,23 +534,29 @@ void MegaApplication::initialize()
     megaApi->setDefaultFolderPermissions(preferences->folderPermissionsValue());
     megaApi->retrySSLerrors(true);
     megaApi->setPublicKeyPinning(!preferences->SSLcertificateException());
+    StartupProfiler::instance()->end(QString::fromUtf8("megaApi"));
 
-    delegateListener = new MEGASyncDelegateListener(megaApi, this);
+    syncResumer = new SyncResumer(megaApi, this);
+    delegateListener = new MEGASyncDelegateListener(megaApi, this, syncResumer);
     megaApi->addListener(delegateListener);
     uploader = new MegaUploader(megaApi);
     downloader = new MegaDownloader(megaApi);
+    transferStatistics = new TransferStatistics(this);
+    connect(transferStatistics, SIGNAL(snapshotReady()), this, SLOT(publishTransferStatistics()));
+    nodeUpdateProcessor = new NodeUpdateProcessor(lastExit, this);
+    connect(nodeUpdateProcessor, SIGNAL(nodesProcessed(NodeUpdateSummary)), this, SLOT(nodeUpdatesProcessed(NodeUpdateSummary)));
+    exclusionEvaluator = new ExclusionEvaluator(this);
+    connect(exclusionEvaluator, SIGNAL(evaluationFinished(ExclusionEvaluation)), this, SLOT(exclusionsEvaluated(ExclusionEvaluation)));
+    exclusionUploader = new ExclusionUploader(megaApi, this);
     scanningTimer = new QTimer();
     scanningTimer->setSingleShot(false);
     scanningTimer->setInterval(500);
     scanningAnimationIndex = 1;
     connect(scanningTimer, SIGNAL(timeout()), this, SLOT(scanningAnimationStep()));
 
-    //Start the HTTP server
-    httpServer = new HTTPServer(megaApi, Preferences::HTTPS_PORT, true);
-    connect(httpServer, SIGNAL(onLinkReceived(QString, QString)), this, SLOT(externalDownload(QString, QString)), Qt::QueuedConnection);
-    connect(httpServer, SIGNAL(onExternalDownloadRequested(QQueue<mega::MegaNode *>)), this, SLOT(externalDownload(QQueue<mega::MegaNode *>)));
-    connect(httpServer, SIGNAL(onExternalDownloadRequestFinished()), this, SLOT(processDownloads()), Qt::QueuedConnection);
-    connect(httpServer, SIGNAL(onSyncRequested(long long)), this, SLOT(syncFolder(long long)), Qt::QueuedConnection);
+    //The HTTP server isn't needed to show the tray icon,
+    //it's started when the event loop is running
+    QTimer::singleShot(0, this, SLOT(startHttpServer()));
 
     connectivityTimer = new QTimer(this);
     connectivityTimer->setSingleShot(true);
@@ -537,22 +564,28 @@ void MegaApplication::initialize()
     connect(connectivityTimer, SIGNAL(timeout()), this, SLOT(runConnectivityCheck()));
 
     connect(uploader, SIGNAL(dupplicateUpload(QString, QString, mega::MegaHandle)), this, SLOT(onDupplicateTransfer(QString, QString, mega::MegaHandle)));
+    connect(uploader, SIGNAL(localCopyProgress(QString, long long, long long)), this, SLOT(onLocalCopyProgress(QString, long long, long long)));
+    connect(uploader, SIGNAL(localCopyFinished(QString, long long, long long, int, int)), this, SLOT(onLocalCopyFinished(QString, long long, long long, int, int)));
     connect(downloader, SIGNAL(dupplicateDownload(QString, QString, mega::MegaHandle)), this, SLOT(onDupplicateTransfer(QString, QString, mega::MegaHandle)));
 
+    //Explicit reload requests remove all the local caches
+    bool fullReload = preferences->needsFullReload();
+    if (fullReload)
+    {
+        preferences->setNeedsFullReload(false);
+        StateCacheVerifier::removeCaches(dataPath);
+    }
+
     if (preferences->isCrashed())
     {
         preferences->setCrashed(false);
-        QDirIterator di(dataPath, QDir::Files | QDir::NoDotAndDotDot);
-        while (di.hasNext())
+
+        //After a crash, only the local caches that are damaged are removed
+        if (!fullReload)
         {
-            di.next();
-            const QFileInfo& fi = di.fileInfo();
-            if (fi.fileName().endsWith(QString::fromAscii(".db"))
-                    || fi.fileName().endsWith(QString::fromAscii(".db-wal"))
-                    || fi.fileName().endsWith(QString::fromAscii(".db-shm")))
-            {
-                QFile::remove(di.filePath());
-            }
+            StartupProfiler::instance()->begin(QString::fromUtf8("verifyCaches"));
+            StateCacheVerifier::verifyCaches(dataPath);
+            StartupProfiler::instance()->end(QString::fromUtf8("verifyCaches"));
         }
 
         QStringList reports = CrashHandler::instance()->getPendingCrashReports();
@@ -595,7 +628,9 @@ void MegaApplication::initialize()
     #endif
 #endif
     QString language = preferences->language();
+    StartupProfiler::instance()->begin(QString::fromUtf8("translator"));
     changeLanguage(language);
+    StartupProfiler::instance()->end(QString::fromUtf8("translator"));
 
 #ifdef __APPLE__
     notificator = new Notificator(applicationName(), NULL, NULL);
@@ -661,38 +696,76 @@ void MegaApplication::changeLanguage(QString languageCode)
         return;
     }
 
-    if (translator)
+    //The same language is requested several times during the startup
+    bool languageChanged = !translator || (languageCode != currentLanguage);
+    if (languageChanged)
     {
-        removeTranslator(translator);
-        delete translator;
-        translator = NULL;
-    }
+        if (translator)
+        {
+            removeTranslator(translator);
+            delete translator;
+            translator = NULL;
+        }
 
-    QTranslator *newTranslator = new QTranslator();
-    if (newTranslator->load(Preferences::TRANSLATION_FOLDER
-                            + Preferences::TRANSLATION_PREFIX
-                            + languageCode)
-            || newTranslator->load(Preferences::TRANSLATION_FOLDER
-                                   + Preferences::TRANSLATION_PREFIX
-                                   + QString::fromUtf8("en")))
-    {
-        installTranslator(newTranslator);
-        translator = newTranslator;
-    }
-    else
-    {
-        delete newTranslator;
+        QTranslator *newTranslator = new QTranslator();
+        if (newTranslator->load(Preferences::TRANSLATION_FOLDER
+                                + Preferences::TRANSLATION_PREFIX
+                                + languageCode)
+                || newTranslator->load(Preferences::TRANSLATION_FOLDER
+                                       + Preferences::TRANSLATION_PREFIX
+                                       + QString::fromUtf8("en")))
+        {
+            installTranslator(newTranslator);
+            translator = newTranslator;
+        }
+        else
+        {
+            delete newTranslator;
+        }
+        currentLanguage = languageCode;
     }
 
+    //The tray menus are created when they are shown for the first time,
+    //only the ones that already exist have to be translated again
     if (notificator)
     {
-        createTrayMenu();
+        if (languageChanged)
+        {
+            if (trayMenu)
+            {
+                createTrayMenu();
+            }
+
+            if (trayOverQuotaMenu)
+            {
+                createOverQuotaMenu();
+            }
+
+            if (trayGuestMenu)
+            {
+                createGuestMenu();
+            }
+        }
         createTrayIcon();
-        createOverQuotaMenu();
-        createGuestMenu();
     }
 }
 
+void MegaApplication::startHttpServer()
+{
+    if (appfinished || httpServer)
+    {
+        return;
+    }
+
+    StartupProfiler::instance()->begin(QString::fromUtf8("httpServer"));
+    httpServer = new HTTPServer(megaApi, Preferences::HTTPS_PORT, true);
+    StartupProfiler::instance()->end(QString::fromUtf8("httpServer"));
+    connect(httpServer, SIGNAL(onLinkReceived(QString, QString)), this, SLOT(externalDownload(QString, QString)), Qt::QueuedConnection);
+    connect(httpServer, SIGNAL(onExternalDownloadRequested(QQueue<mega::MegaNode *>)), this, SLOT(externalDownload(QQueue<mega::MegaNode *>)));
+    connect(httpServer, SIGNAL(onExternalDownloadRequestFinished()), this, SLOT(processDownloads()), Qt::QueuedConnection);
+    connect(httpServer, SIGNAL(onSyncRequested(long long)), this, SLOT(syncFolder(long long)), Qt::QueuedConnection);
+}
+
 void MegaApplication::updateTrayIcon()
 {
     if (appfinished)
@@ -707,6 +780,7 @@ void MegaApplication::updateTrayIcon()
 
     QString tooltip;
     QString icon;
+    bool showEta = false;
 
 #ifdef __APPLE__
     QString icon_white;
@@ -877,6 +951,7 @@ void MegaApplication::updateTrayIcon()
                     + Preferences::VERSION_STRING
                     + QString::fromAscii("\n")
                     + tr("Syncing");
+            showEta = true;
         }
 
 #ifndef __APPLE__
@@ -928,6 +1003,7 @@ void MegaApplication::updateTrayIcon()
     if (!networkConnectivity)
     {
         //Override the current state
+        showEta = false;
         tooltip = QCoreApplication::applicationName()
                 + QString::fromAscii(" ")
                 + Preferences::VERSION_STRING
@@ -946,12 +1022,6 @@ void MegaApplication::updateTrayIcon()
 #endif
     }
 
-    if (updateAvailable)
-    {
-        tooltip += QString::fromAscii("\n")
-                + tr("Update available!");
-    }
-
     if (!icon.isEmpty())
     {
 #ifndef __APPLE__
@@ -961,7 +1031,40 @@ void MegaApplication::updateTrayIcon()
 #endif
     }
 
-    if (!tooltip.isEmpty())
+    trayTooltip = tooltip;
+    trayTooltipShowsEta = showEta;
+    updateTrayTooltip();
+}
+
+void MegaApplication::updateTrayTooltip()
+{
+    if (appfinished || !trayIcon || trayTooltip.isEmpty())
+    {
+        return;
+    }
+
+    //The ETA changes with every snapshot of the transfer statistics,
+    //so it's added here instead of in updateTrayIcon
+    QString tooltip = trayTooltip;
+    if (trayTooltipShowsEta && transferStatistics)
+    {
+        long long remainingSeconds = qMax(transferStatistics->getRemainingSeconds(MegaTransfer::TYPE_DOWNLOAD),
+                                          transferStatistics->getRemainingSeconds(MegaTransfer::TYPE_UPLOAD));
+        if (remainingSeconds > 0)
+        {
+            tooltip += QString::fromAscii(" (")
+                    + Utilities::getRemainingTimeString(remainingSeconds)
+                    + QString::fromAscii(")");
+        }
+    }
+
+    if (updateAvailable)
+    {
+        tooltip += QString::fromAscii("\n")
+                + tr("Update available!");
+    }
+
+    if (tooltip != trayIcon->toolTip())
     {
         trayIcon->setToolTip(tooltip);
     }
@@ -974,6 +1077,8 @@ void MegaApplication::start()
         return;
     }
 
+    StartupPhase startupPhase("start");
+
     indexing = false;
     overquotaCheck = false;
 
@@ -1008,8 +1113,10 @@ void MegaApplication::start()
         scanningTimer->start();
     }
 #endif
+    trayTooltipShowsEta = false;
     trayIcon->setToolTip(QCoreApplication::applicationName() + QString::fromAscii(" ") + Preferences::VERSION_STRING + QString::fromAscii("\n") + tr("Logging in"));
     trayIcon->show();
+    StartupProfiler::instance()->mark(QString::fromUtf8("trayShown"));
 
     if (!preferences->lastExecutionTime())
     {
@@ -1045,7 +1152,7 @@ void MegaApplication::start()
             preferences->setInstallationTime(QDateTime::currentDateTime().toMSecsSinceEpoch() / 1000);
         }
 
-        startUpdateTask();
+        QTimer::singleShot(0, this, SLOT(startUpdateTask()));
         QString language = preferences->language();
         changeLanguage(language);
         updated = false;
@@ -1092,6 +1199,7 @@ void MegaApplication::start()
         }
 
         //Otherwise, login in the account
+        StartupProfiler::instance()->begin(QString::fromUtf8("login"));
         if (preferences->getSession().size())
         {
             megaApi->fastLogin(preferences->getSession().toUtf8().constData());
@@ -1185,10 +1293,10 @@ void MegaApplication::loggedIn()
 
     // Process any pending download queued during GuestMode
     processDownloads();
-    for (QMap<QString, QString>::iterator it = pendingLinks.begin(); it != pendingLinks.end(); it++)
+    QStringList links = pendingLinks.keys();
+    for (int i = 0; i < links.size(); i++)
     {
-        QString link = it.key();
-        megaApi->getPublicNode(link.toUtf8().constData());
+        requestPublicNode(links[i]);
     }
 
     onGlobalSyncStateChanged(megaApi);
@@ -1359,6 +1467,145 @@ void MegaApplication::restoreSyncs()
     }
 }
 
+void MegaApplication::rescanSync(int syncId)
+{
+    if (appfinished || syncRescanners.contains(syncId))
+    {
+        return;
+    }
+
+    int index = preferences->getSyncIndexById(syncId);
+    if (index < 0 || !preferences->isFolderActive(index))
+    {
+        return;
+    }
+
+    SyncRescanner *rescanner = new SyncRescanner(megaApi, syncId, preferences->getLocalFolder(index), this);
+    connect(rescanner, SIGNAL(rescanProgress(int, long long, long long, int, int)),
+            this, SLOT(onSyncRescanProgress(int, long long, long long, int, int)));
+    connect(rescanner, SIGNAL(rescanFinished(int, long long, long long, long long, bool)),
+            this, SLOT(onSyncRescanFinished(int, long long, long long, long long, bool)));
+    syncRescanners.insert(syncId, rescanner);
+    rescanner->start(QThread::LowPriority);
+}
+
+void MegaApplication::repairSync(int syncId)
+{
+    repairSyncs(QList<int>() << syncId);
+}
+
+void MegaApplication::repairSyncs(QList<int> syncIds)
+{
+    if (appfinished || !syncResumer)
+    {
+        return;
+    }
+
+    //The syncs are removed with their local caches and added again when the removals finish,
+    //so the engine compares the whole folders with the cloud. The rest of the syncs keep running
+    syncResumer->repairSyncs(syncIds);
+}
+
+bool MegaApplication::isRescanningSync(int syncId)
+{
+    return syncRescanners.contains(syncId);
+}
+
+void MegaApplication::onSyncRescanProgress(int syncId, long long numFolders, long long numFiles,
+                                           int foldersPerSecond, int filesPerSecond)
+{
+    if (appfinished)
+    {
+        return;
+    }
+
+    MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, QString::fromUtf8("Rescan of sync %1: %2 folders, %3 files (%4 folders/s, %5 files/s)")
+                 .arg(syncId).arg(numFolders).arg(numFiles).arg(foldersPerSecond).arg(filesPerSecond).toUtf8().constData());
+
+    if (settingsDialog)
+    {
+        settingsDialog->setSyncRescanStatus(syncId, tr("Rescanning: %1 folders, %2 files (%3 folders/s, %4 files/s)")
+                                            .arg(numFolders).arg(numFiles).arg(foldersPerSecond).arg(filesPerSecond));
+    }
+}
+
+void MegaApplication::onSyncRescanFinished(int syncId, long long, long long, long long numMismatches, bool cancelled)
+{
+    SyncRescanner *rescanner = syncRescanners.take(syncId);
+    if (rescanner)
+    {
+        rescanner->wait();
+        rescanner->deleteLater();
+    }
+
+    if (appfinished || cancelled)
+    {
+        return;
+    }
+
+    if (settingsDialog)
+    {
+        settingsDialog->setSyncRescanStatus(syncId, QString());
+    }
+
+    int index = preferences->getSyncIndexById(syncId);
+    if (index < 0 || !preferences->isFolderActive(index))
+    {
+        return;
+    }
+
+    if (!numMismatches)
+    {
+        showNotificationMessage(tr("Your sync \"%1\" is up to date").arg(preferences->getSyncName(index)));
+        return;
+    }
+
+    showNotificationMessage(tr("Your sync \"%1\" is being repaired").arg(preferences->getSyncName(index)));
+    repairSync(syncId);
+}
+
+void MegaApplication::reevaluateExclusions(const ExclusionRules &oldRules)
+{
+    if (appfinished)
+    {
+        return;
+    }
+
+    QList<ExclusionSync> syncs;
+    for (int i = 0; i < preferences->getNumSyncedFolders(); i++)
+    {
+        if (preferences->isFolderActive(i))
+        {
+            ExclusionSync sync;
+            sync.syncId = preferences->getSyncId(i);
+            sync.localFolder = preferences->getLocalFolder(i);
+            sync.megaFolderHandle = preferences->getMegaFolderHandle(i);
+            syncs.append(sync);
+        }
+    }
+
+    exclusionEvaluator->evaluate(oldRules, ExclusionRules::fromPreferences(preferences), syncs);
+}
+
+void MegaApplication::exclusionsEvaluated(const ExclusionEvaluation &evaluation)
+{
+    if (appfinished)
+    {
+        return;
+    }
+
+    MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Exclusion rules applied: %1 entries visited, %2 entries included in %3 ms")
+                 .arg(evaluation.numVisited).arg(evaluation.newlyIncluded.size()).arg(evaluation.elapsedMs).toUtf8().constData());
+
+    //Only the entries that aren't excluded anymore are created in the cloud,
+    //the rest of the syncs are left alone
+    if (evaluation.newlyIncluded.size() && exclusionUploader)
+    {
+        exclusionUploader->upload(evaluation.newlyIncluded);
+        showNotificationMessage(tr("%1 items that are no longer excluded are being synced").arg(evaluation.newlyIncluded.size()));
+    }
+}
+
 void MegaApplication::closeDialogs()
 {
     delete setupWizard;
@@ -1690,6 +1937,26 @@ void MegaApplication::periodicTasks()
         megaApi->updateStats();
         onGlobalSyncStateChanged(megaApi);
 
+        //The retention policy of the local debris (disabled by default) runs in the
+        //background with the lowest priority, once the syncs have been resumed
+        long long now = QDateTime::currentMSecsSinceEpoch();
+        if (preferences->logged() && !debrisRetentionTask->isRunning()
+                && (preferences->debrisMaxAgeDays() > 0 || preferences->debrisMaxSizeMB() > 0)
+                && syncResumer && !syncResumer->isResuming()
+                && (now - lastDebrisRetention) > Preferences::DEBRIS_RETENTION_INTERVAL_MS)
+        {
+            QStringList localFolders;
+            for (int i = 0; i < preferences->getNumSyncedFolders(); i++)
+            {
+                localFolders.append(preferences->getLocalFolder(i));
+            }
+
+            lastDebrisRetention = now;
+            debrisRetentionTask->setPolicy(localFolders, preferences->debrisMaxAgeDays(),
+                                           preferences->debrisMaxSizeMB() * 1024 * 1024);
+            debrisRetentionTask->start(QThread::IdlePriority);
+        }
+
         if (isLinux)
         {
             updateTrayIcon();
@@ -1717,6 +1984,18 @@ void MegaApplication::cleanAll()
 
     periodicTasksTimer->stop();
     stopUpdateTask();
+
+    //Rescanners use the MegaApi object
+    QList<SyncRescanner *> rescanners = syncRescanners.values();
+    for (int i = 0; i < rescanners.size(); i++)
+    {
+        rescanners[i]->cancel();
+        rescanners[i]->wait();
+        delete rescanners[i];
+    }
+    syncRescanners.clear();
+    DebrisTracker::instance()->cancel();
+    debrisRetentionTask->wait();
     Platform::stopShellDispatcher();
     for (int i = 0; i < preferences->getNumSyncedFolders(); i++)
     {
@@ -1739,6 +2018,10 @@ void MegaApplication::cleanAll()
     uploader = NULL;
     delete delegateListener;
     delegateListener = NULL;
+    delete syncResumer;
+    syncResumer = NULL;
+    delete exclusionUploader;
+    exclusionUploader = NULL;
 
     // Ensure that there aren't objects deleted with deleteLater()
     // that may try to access megaApi after
@@ -1747,6 +2030,7 @@ void MegaApplication::cleanAll()
 
     delete megaApi;
 
+    StartupProfiler::instance()->finish();
     preferences->setLastExit(QDateTime::currentMSecsSinceEpoch());
     trayIcon->deleteLater();
 
@@ -1799,6 +2083,66 @@ void MegaApplication::onDupplicateTransfer(QString localPath, QString name, Mega
     addRecentFile(name, handle, localPath, nodeKey);
 }
 
+long long MegaApplication::getUploadRate()
+{
+    if (measuredUploadRate > 0)
+    {
+        return measuredUploadRate;
+    }
+
+    int uploadLimitKB = preferences->logged() ? preferences->uploadLimitKB() : -1;
+    if (uploadLimitKB > 0)
+    {
+        return uploadLimitKB * 1024LL;
+    }
+    return -1;
+}
+
+void MegaApplication::onLocalCopyProgress(QString localPath, long long copiedBytes, long long totalBytes)
+{
+    MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, QString::fromUtf8("Copying into synced folder: %1 (%2/%3 bytes)")
+                 .arg(localPath).arg(copiedBytes).arg(totalBytes).toUtf8().constData());
+
+    if (appfinished)
+    {
+        return;
+    }
+
+    //Progress is emitted every LOCAL_COPY_PROGRESS_INTERVAL_MS at most
+    localCopyPath = localPath;
+    if (infoDialog)
+    {
+        infoDialog->setLocalCopyProgress(QFileInfo(localPath).fileName(), copiedBytes, totalBytes);
+    }
+}
+
+void MegaApplication::onLocalCopyFinished(QString localPath, long long copiedBytes, long long clonedBytes, int numFiles, int numErrors)
+{
+    MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Copy into synced folder finished: %1 (%2 files, %3 bytes, %4 bytes cloned, %5 errors)")
+                 .arg(localPath).arg(numFiles).arg(copiedBytes).arg(clonedBytes).arg(numErrors).toUtf8().constData());
+
+    if (appfinished)
+    {
+        return;
+    }
+
+    if (localCopyPath == localPath)
+    {
+        localCopyPath.clear();
+        if (infoDialog)
+        {
+            infoDialog->setLocalCopyProgress(QString(), 0, 0);
+        }
+    }
+
+    if (!numErrors)
+    {
+        return;
+    }
+
+    showWarningMessage(tr("%1 files couldn't be copied to your synced folder").arg(numErrors), QFileInfo(localPath).fileName());
+}
+
 void MegaApplication::onInstallUpdateClicked()
 {
     if (appfinished)
@@ -1860,7 +2204,7 @@ void MegaApplication::showInfoDialog()
         }
         else
         {
-            if (trayOverQuotaMenu->isVisible())
+            if (trayOverQuotaMenu && trayOverQuotaMenu->isVisible())
             {
                 trayOverQuotaMenu->close();
             }
@@ -1897,16 +2241,16 @@ void MegaApplication::showInfoDialog()
             infoDialog->setFocus();
             infoDialog->raise();
             infoDialog->activateWindow();
-            infoDialog->updateTransfers();
+            publishTransferStatistics();
         }
         else
         {
             infoDialog->closeSyncsMenu();
-            if (trayMenu->isVisible())
+            if (trayMenu && trayMenu->isVisible())
             {
                 trayMenu->close();
             }
-            if (trayGuestMenu->isVisible())
+            if (trayGuestMenu && trayGuestMenu->isVisible())
             {
                 trayGuestMenu->close();
             }
@@ -2551,6 +2895,25 @@ void MegaApplication::showTrayMenu(QPoint *point)
         return;
     }
 
+    if (!preferences->logged())
+    {
+        if (!trayGuestMenu)
+        {
+            createGuestMenu();
+        }
+    }
+    else if (infoOverQuota)
+    {
+        if (!trayOverQuotaMenu)
+        {
+            createOverQuotaMenu();
+        }
+    }
+    else if (!trayMenu)
+    {
+        createTrayMenu();
+    }
+
     if (trayGuestMenu && !preferences->logged())
     {
         if (trayGuestMenu->isVisible())
@@ -2992,6 +3355,7 @@ void MegaApplication::createTrayIcon()
     trayIcon->setContextMenu(&emptyMenu);
 #endif
 
+    trayTooltipShowsEta = false;
     trayIcon->setToolTip(QCoreApplication::applicationName()
                      + QString::fromAscii(" ")
                      + Preferences::VERSION_STRING
@@ -3269,7 +3633,7 @@ void MegaApplication::externalDownload(QString megaLink, QString auth)
 
     if (preferences->logged())
     {
-        megaApi->getPublicNode(megaLink.toUtf8().constData());
+        requestPublicNode(megaLink);
     }
     else
     {
@@ -3277,6 +3641,25 @@ void MegaApplication::externalDownload(QString megaLink, QString auth)
     }
 }
 
+void MegaApplication::requestPublicNode(QString megaLink)
+{
+    MegaNode *node = PublicNodeCache::instance()->getNode(megaLink);
+    if (!node)
+    {
+        megaApi->getPublicNode(megaLink.toUtf8().constData());
+        return;
+    }
+
+    QString auth = pendingLinks.take(megaLink);
+    if (auth.size())
+    {
+        node->setPrivateAuth(auth.toUtf8().constData());
+    }
+
+    downloadQueue.append(node);
+    processDownloads();
+}
+
 void MegaApplication::internalDownload(long long handle)
 {
     if (appfinished)
@@ -3331,6 +3714,7 @@ void MegaApplication::onRequestLinksFinished()
     QStringList links = exportProcessor->getValidLinks();
     if (!links.size())
     {
+        exportProcessor->deleteLater();
         exportOps--;
         return;
     }
@@ -4198,6 +4582,7 @@ void MegaApplication::onRequestFinish(MegaApi*, MegaRequest *request, MegaError*
     case MegaRequest::TYPE_LOGIN:
     {
         connectivityTimer->stop();
+        StartupProfiler::instance()->end(QString::fromUtf8("login"));
 
         //This prevents to handle logins in the initial setup wizard
         if (preferences->logged())
@@ -4213,6 +4598,7 @@ void MegaApplication::onRequestFinish(MegaApi*, MegaRequest *request, MegaError*
                     delete [] session;
 
                     //Successful login, fetch nodes
+                    StartupProfiler::instance()->begin(QString::fromUtf8("fetchNodes"));
                     megaApi->fetchNodes();
                     break;
                 }
@@ -4332,6 +4718,7 @@ void MegaApplication::onRequestFinish(MegaApi*, MegaRequest *request, MegaError*
     }
     case MegaRequest::TYPE_FETCH_NODES:
     {
+        StartupProfiler::instance()->end(QString::fromUtf8("fetchNodes"));
         //This prevents to handle node requests in the initial setup wizard
         if (preferences->logged())
         {
@@ -4348,7 +4735,7 @@ void MegaApplication::onRequestFinish(MegaApi*, MegaRequest *request, MegaError*
                 }
                 else
                 {
-                    preferences->setCrashed(true);
+                    preferences->setNeedsFullReload(true);
                 }
             }
             else
@@ -4380,7 +4767,7 @@ void MegaApplication::onRequestFinish(MegaApi*, MegaRequest *request, MegaError*
         MegaNodeList *inShares = megaApi->getInShares();
         if (!root || !inbox || !rubbish || !inShares)
         {
-            preferences->setCrashed(true);
+            preferences->setNeedsFullReload(true);
             delete root;
             delete inbox;
             delete rubbish;
@@ -4489,6 +4876,9 @@ void MegaApplication::onRequestFinish(MegaApi*, MegaRequest *request, MegaError*
     }
     case MegaRequest::TYPE_ADD_SYNC:
     {
+        //The slot of the sync is released when it leaves the initial scan
+        syncResumer->onSyncAdded(request->getNodeHandle(), e->getErrorCode());
+
         for (int i = preferences->getNumSyncedFolders() - 1; i >= 0; i--)
         {
             if ((request->getNodeHandle() == preferences->getMegaFolderHandle(i)))
@@ -4649,6 +5039,7 @@ void MegaApplication::onRequestFinish(MegaApi*, MegaRequest *request, MegaError*
             if (e->getErrorCode() == MegaError::API_OK)
             {
                 MegaNode *node = request->getPublicMegaNode();
+                PublicNodeCache::instance()->addNode(link, node);
                 if (auth.size())
                 {
                     node->setPrivateAuth(auth.toUtf8().constData());
@@ -4697,31 +5088,14 @@ void MegaApplication::onTransferStart(MegaApi *, MegaTransfer *transfer)
         return;
     }
 
-    if (infoDialog && !totalUploadSize && !totalDownloadSize)
+    if (infoDialog && transferStatistics->isEmpty())
     {
         infoDialog->setWaiting(true);
         onGlobalSyncStateChanged(megaApi);
     }
 
-    //Update statics
-    if (transfer->getType() == MegaTransfer::TYPE_DOWNLOAD)
-    {
-        downloadSpeed = 0;
-        totalDownloadSize += transfer->getTotalBytes();
-    }
-    else
-    {
-        uploadSpeed = 0;
-        totalUploadSize += transfer->getTotalBytes();
-    }
-
-    //Send statics to the information dialog
-    if (infoDialog)
-    {
-        infoDialog->setTotalTransferSize(totalDownloadSize, totalUploadSize);
-        infoDialog->setTransferSpeeds(downloadSpeed, uploadSpeed);
-        infoDialog->updateTransfers();
-    }
+    //Update statics, they are sent to the information dialog periodically
+    transferStatistics->onTransferStart(transfer);
 }
 
 //Called when there is a temporal problem in a request
@@ -4781,11 +5155,9 @@ void MegaApplication::onTransferFinish(MegaApi* , MegaTransfer *transfer, MegaEr
     }
 
     //Update statics
+    transferStatistics->onTransferFinish(transfer, e->getErrorCode());
     if (transfer->getType()==MegaTransfer::TYPE_DOWNLOAD)
     {
-        totalDownloadedSize += transfer->getDeltaSize();
-        downloadSpeed = transfer->getSpeed();
-
         //Show the transfer in the "recently updated" list
         if (e->getErrorCode() == MegaError::API_OK)
         {
@@ -4811,9 +5183,6 @@ void MegaApplication::onTransferFinish(MegaApi* , MegaTransfer *transfer, MegaEr
     }
     else
     {
-        totalUploadedSize += transfer->getDeltaSize();
-        uploadSpeed = transfer->getSpeed();
-
         //Here the file isn't added to the "recently updated" list,
         //because the file isn't in the destination folder yet.
         //The SDK still has to put the new node.
@@ -4832,39 +5201,23 @@ void MegaApplication::onTransferFinish(MegaApi* , MegaTransfer *transfer, MegaEr
         }
     }
 
+    int numPendingDownloads = megaApi->getNumPendingDownloads();
+    int numPendingUploads = megaApi->getNumPendingUploads();
+
     //Send updated statics to the information dialog
     if (infoDialog)
     {
-        if (e->getErrorCode() == MegaError::API_OK)
+        if (!numPendingDownloads && !numPendingUploads)
         {
-            if (((transfer->getType() == MegaTransfer::TYPE_DOWNLOAD) && (transfer->getStartTime()>=lastStartedDownload)) ||
-                ((transfer->getType() == MegaTransfer::TYPE_UPLOAD) && (transfer->getStartTime()>=lastStartedUpload)))
-            {
-                infoDialog->setTransfer(transfer);
-            }
-
-            infoDialog->setTransferSpeeds(downloadSpeed, uploadSpeed);
-            infoDialog->setTransferredSize(totalDownloadedSize, totalUploadedSize);
+            //A batch has finished, the dialog must be up to date before
+            //starting its "transfers finished" timers
+            transferStatistics->flush();
         }
-
-        infoDialog->updateTransfers();
         infoDialog->transferFinished(e->getErrorCode());
     }
 
-    if (transfer->getType() == MegaTransfer::TYPE_DOWNLOAD)
+    if (transfer->getType() == MegaTransfer::TYPE_UPLOAD)
     {
-        if (lastStartedDownload == transfer->getStartTime())
-        {
-            lastStartedDownload = 0;
-        }
-    }
-    else
-    {
-        if (lastStartedUpload == transfer->getStartTime())
-        {
-            lastStartedUpload = 0;
-        }
-
         if ((e->getErrorCode() == MegaError::API_OK))
         {
             if (settingsDialog)
@@ -4905,16 +5258,14 @@ void MegaApplication::onTransferFinish(MegaApi* , MegaTransfer *transfer, MegaEr
     }
 
     //If there are no pending transfers, reset the statics and update the state of the tray icon
-    if (!megaApi->getNumPendingDownloads() && !megaApi->getNumPendingUploads())
+    if (!numPendingDownloads && !numPendingUploads)
     {
-        if (totalUploadSize || totalDownloadSize)
+        if (!transferStatistics->isEmpty())
         {
             onGlobalSyncStateChanged(megaApi);
         }
 
-        totalUploadSize = totalDownloadSize = 0;
-        totalUploadedSize = totalDownloadedSize = 0;
-        uploadSpeed = downloadSpeed = 0;
+        transferStatistics->reset();
     }
 }
 
@@ -4926,38 +5277,45 @@ void MegaApplication::onTransferUpdate(MegaApi *, MegaTransfer *transfer)
         return;
     }
 
-    //Update statics
-    if (transfer->getType() == MegaTransfer::TYPE_DOWNLOAD)
+    //Update statics, they are sent to the information dialog periodically
+    transferStatistics->onTransferUpdate(transfer);
+}
+
+void MegaApplication::publishTransferStatistics()
+{
+    if (appfinished)
     {
-        downloadSpeed = transfer->getSpeed();
-        if (!lastStartedDownload || !transfer->getTransferredBytes())
-        {
-            lastStartedDownload = transfer->getStartTime();
-        }
-        totalDownloadedSize += transfer->getDeltaSize();
+        return;
     }
-    else
+
+    double uploadRate = transferStatistics->getRate(MegaTransfer::TYPE_UPLOAD);
+    if (uploadRate > 0)
     {
-        uploadSpeed = transfer->getSpeed();
-        if (!lastStartedUpload || !transfer->getTransferredBytes())
-        {
-            lastStartedUpload = transfer->getStartTime();
-        }
-        totalUploadedSize += transfer->getDeltaSize();
+        measuredUploadRate = (long long)uploadRate;
     }
 
-    //Send updated statics to the information dialog
-    if (infoDialog)
+    if (trayTooltipShowsEta)
     {
-        if (((transfer->getType() == MegaTransfer::TYPE_DOWNLOAD) && (transfer->getStartTime()>=lastStartedDownload)) ||
-            ((transfer->getType() == MegaTransfer::TYPE_UPLOAD) && (transfer->getStartTime()>=lastStartedUpload)))
-        {
-            infoDialog->setTransfer(transfer);
-            infoDialog->setTransferSpeeds(downloadSpeed, uploadSpeed);
-            infoDialog->setTransferredSize(totalDownloadedSize, totalUploadedSize);
-            infoDialog->updateTransfers();
-        }
+        updateTrayTooltip();
+    }
+
+    if (!infoDialog || !infoDialog->isVisible())
+    {
+        return;
     }
+
+    TransferDirectionStats downloads = transferStatistics->getStats(MegaTransfer::TYPE_DOWNLOAD);
+    TransferDirectionStats uploads = transferStatistics->getStats(MegaTransfer::TYPE_UPLOAD);
+    infoDialog->setTransfer(transferStatistics->getDisplayedTransfer(MegaTransfer::TYPE_DOWNLOAD),
+                            transferStatistics->getDisplayedTransferredBytes(MegaTransfer::TYPE_DOWNLOAD));
+    infoDialog->setTransfer(transferStatistics->getDisplayedTransfer(MegaTransfer::TYPE_UPLOAD),
+                            transferStatistics->getDisplayedTransferredBytes(MegaTransfer::TYPE_UPLOAD));
+    infoDialog->setTotalTransferSize(downloads.totalBytes, uploads.totalBytes);
+    infoDialog->setTransferSpeeds(downloads.speed, uploads.speed);
+    infoDialog->setTransferredSize(downloads.transferredBytes, uploads.transferredBytes);
+    infoDialog->setRemainingTime(transferStatistics->getRemainingSeconds(MegaTransfer::TYPE_DOWNLOAD),
+                                 transferStatistics->getRemainingSeconds(MegaTransfer::TYPE_UPLOAD));
+    infoDialog->updateTransfers();
 }
 
 //Called when there is a temporal problem in a transfer
@@ -5029,141 +5387,133 @@ void MegaApplication::onUsersUpdate(MegaApi* , MegaUserList *)
 //Called when nodes have been updated in MEGA
 void MegaApplication::onNodesUpdate(MegaApi* , MegaNodeList *nodes)
 {
-    if (appfinished || !infoDialog || !nodes || !preferences->logged())
+    if (appfinished)
+    {
+        return;
+    }
+
+    //Node selectors can be open before the info dialog exists
+    emit nodesUpdated();
+
+    if (!infoDialog || !nodes || !preferences->logged())
     {
         return;
     }
 
-    bool externalNodes = 0;
-    bool nodesRemoved = false;
-    long long usedStorage = preferences->usedStorage();
     MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("%1 updated files/folders").arg(nodes->size()).toUtf8().constData());
 
-    //Check all modified nodes
-    QString localPath;
-    for (int i = 0; i < nodes->size(); i++)
+    //The classification of the nodes runs in a worker thread,
+    //only the summary is processed in nodeUpdatesProcessed
+    nodeUpdateProcessor->processNodes(nodes->copy());
+}
+
+void MegaApplication::nodeUpdatesProcessed(const NodeUpdateSummary &summary)
+{
+    if (appfinished || !infoDialog || !preferences->logged())
     {
-        localPath.clear();
-        MegaNode *node = nodes->get(i);
+        return;
+    }
 
-        for (int i = 0; i < preferences->getNumSyncedFolders(); i++)
+    long long startTime = QDateTime::currentMSecsSinceEpoch();
+    if (summary.syncRoots.size())
+    {
+        QHash<MegaHandle, int> syncRoots = preferences->getActiveSyncRoots();
+        for (int i = 0; i < summary.syncRoots.size(); i++)
         {
-            if (!preferences->isFolderActive(i))
+            QHash<MegaHandle, int>::iterator syncRoot = syncRoots.find(summary.syncRoots.at(i));
+            if (syncRoot == syncRoots.end())
             {
                 continue;
             }
 
-            if (node->getType() == MegaNode::TYPE_FOLDER
-                    && (node->getHandle() == preferences->getMegaFolderHandle(i)))
-            {
-                MegaNode *nodeByHandle = megaApi->getNodeByHandle(preferences->getMegaFolderHandle(i));
-                const char *nodePath = megaApi->getNodePath(nodeByHandle);
+            int syncIndex = syncRoot.value();
+            MegaNode *nodeByHandle = megaApi->getNodeByHandle(syncRoot.key());
+            const char *nodePath = megaApi->getNodePath(nodeByHandle);
 
-                if (!nodePath || preferences->getMegaFolder(i).compare(QString::fromUtf8(nodePath)))
+            if (!nodePath || preferences->getMegaFolder(syncIndex).compare(QString::fromUtf8(nodePath)))
+            {
+                if (nodePath && QString::fromUtf8(nodePath).startsWith(QString::fromUtf8("//bin")))
                 {
-                    if (nodePath && QString::fromUtf8(nodePath).startsWith(QString::fromUtf8("//bin")))
-                    {
-                        showErrorMessage(tr("Your sync \"%1\" has been disabled because the remote folder is in the rubbish bin")
-                                         .arg(preferences->getSyncName(i)));
-                    }
-                    else
-                    {
-                        showErrorMessage(tr("Your sync \"%1\" has been disabled because the remote folder doesn't exist")
-                                         .arg(preferences->getSyncName(i)));
-                    }
-                    Platform::syncFolderRemoved(preferences->getLocalFolder(i), preferences->getSyncName(i));
-                    Platform::notifyItemChange(preferences->getLocalFolder(i));
-                    MegaNode *node = megaApi->getNodeByHandle(preferences->getMegaFolderHandle(i));
-                    megaApi->removeSync(node);
-                    delete node;
-                    preferences->setSyncState(i, false);
-                    openSettings(SettingsDialog::SYNCS_TAB);
+                    showErrorMessage(tr("Your sync \"%1\" has been disabled because the remote folder is in the rubbish bin")
+                                     .arg(preferences->getSyncName(syncIndex)));
                 }
-
-                delete nodeByHandle;
-                delete [] nodePath;
+                else
+                {
+                    showErrorMessage(tr("Your sync \"%1\" has been disabled because the remote folder doesn't exist")
+                                     .arg(preferences->getSyncName(syncIndex)));
+                }
+                Platform::syncFolderRemoved(preferences->getLocalFolder(syncIndex), preferences->getSyncName(syncIndex));
+                Platform::notifyItemChange(preferences->getLocalFolder(syncIndex));
+                megaApi->removeSync(nodeByHandle);
+                preferences->setSyncState(syncIndex, false);
+                syncRoots.erase(syncRoot);
+                openSettings(SettingsDialog::SYNCS_TAB);
             }
-        }
 
-        if (!node->getTag() && !node->isRemoved()
-                && !node->isSyncDeleted()
-                && ((lastExit / 1000) < node->getCreationTime()))
-        {
-            externalNodes++;
+            delete nodeByHandle;
+            delete [] nodePath;
         }
+    }
 
-        if (node->isRemoved() && (node->getType() == MegaNode::TYPE_FILE))
-        {
-            usedStorage -= node->getSize();
-            nodesRemoved = true;
-        }
+    for (int i = 0; i < summary.skippedUploadTags.size(); i++)
+    {
+        uploadLocalPaths.remove(summary.skippedUploadTags.at(i));
+    }
 
-        if (!node->isRemoved() && node->getTag()
-                && !node->isSyncDeleted()
-                && (node->getType() == MegaNode::TYPE_FILE))
+    for (int i = 0; i < summary.recentFiles.size(); i++)
+    {
+        const NodeUpdateRecentFile &recentFile = summary.recentFiles.at(i);
+        QString localPath = recentFile.localPath;
+        if (localPath.isEmpty())
         {
-            //Get the associated local node
-            string path = node->getLocalPath();
-            if (path.size())
-            {
-                //If the node has been uploaded by a synced folder
-                //the SDK provides its local path
-#ifdef WIN32
-                localPath = QString::fromWCharArray((const wchar_t *)path.data());
-                if (localPath.startsWith(QString::fromAscii("\\\\?\\")))
-                {
-                    localPath = localPath.mid(4);
-                }
-#else
-                localPath = QString::fromUtf8(path.data());
-#endif
-            }
-            else if (uploadLocalPaths.contains(node->getTag()))
+            if (uploadLocalPaths.contains(recentFile.tag))
             {
                 //If the node has been uploaded by a regular upload,
                 //we recover the path using the tag of the transfer
-                localPath = uploadLocalPaths.value(node->getTag());
-                uploadLocalPaths.remove(node->getTag());
+                localPath = uploadLocalPaths.value(recentFile.tag);
+                uploadLocalPaths.remove(recentFile.tag);
             }
             else
             {
                 MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Unable to get the local path of the file: %1 Tag: %2")
-                             .arg(QString::fromUtf8(node->getName())).arg(node->getTag()).toUtf8().constData());
+                             .arg(recentFile.fileName).arg(recentFile.tag).toUtf8().constData());
             }
+        }
+
+        addRecentFile(recentFile.fileName, recentFile.handle, localPath);
+    }
 
-            addRecentFile(QString::fromUtf8(node->getName()), node->getHandle(), localPath);
-            if (node->getAttrString()->size())
+    if (summary.noKeyNodes)
+    {
+        //NO_KEY node created by this client detected
+        if (!noKeyDetected)
+        {
+            if (megaApi->isLoggedIn())
             {
-                //NO_KEY node created by this client detected
-                if (!noKeyDetected)
-                {
-                    if (megaApi->isLoggedIn())
-                    {
-                        megaApi->fetchNodes();
-                    }
-                }
-                else if (noKeyDetected > 20)
-                {
-                    QMessageBox::critical(NULL, QString::fromUtf8("MEGAsync"),
-                        QString::fromUtf8("Something went wrong. MEGAsync will restart now. If the problem persists please contact bug@mega.co.nz"));
-                    preferences->setCrashed(true);
-                    rebootApplication(false);
-                }
-                noKeyDetected++;
+                megaApi->fetchNodes();
             }
         }
+
+        noKeyDetected += summary.noKeyNodes;
+        if (noKeyDetected > 21)
+        {
+            QMessageBox::critical(NULL, QString::fromUtf8("MEGAsync"),
+                QString::fromUtf8("Something went wrong. MEGAsync will restart now. If the problem persists please contact bug@mega.co.nz"));
+            preferences->setNeedsFullReload(true);
+            rebootApplication(false);
+        }
     }
 
-    if (nodesRemoved)
+    if (summary.nodesRemoved)
     {
-        preferences->setUsedStorage(usedStorage);
+        preferences->setUsedStorage(preferences->usedStorage() - summary.removedBytes);
         if (infoOverQuota && (preferences->usedStorage() < preferences->totalStorage()))
         {
             updateUserStats();
         }
     }
 
-    if (externalNodes)
+    if (summary.externalNodes)
     {
         updateUserStats();
 
@@ -5173,6 +5523,10 @@ void MegaApplication::onNodesUpdate(MegaApi* , MegaNodeList *nodes)
             showNotificationMessage(tr("You have new or updated files in your account"));
         }
     }
+
+    MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, QString::fromUtf8("%1 updated files/folders processed in %2 ms (%3 ms in the GUI thread)")
+                 .arg(summary.numNodes).arg(summary.elapsedMs)
+                 .arg(QDateTime::currentMSecsSinceEpoch() - startTime).toUtf8().constData());
 }
 
 void MegaApplication::onReloadNeeded(MegaApi*)
@@ -5184,8 +5538,8 @@ void MegaApplication::onReloadNeeded(MegaApi*)
 
     //Don't reload the filesystem here because it's unsafe
     //and the most probable cause for this callback is a false positive.
-    //Simply set the crashed flag to force a filesystem reload in the next execution.
-    preferences->setCrashed(true);
+    //Simply set the flag to force a filesystem reload in the next execution.
+    preferences->setNeedsFullReload(true);
     //megaApi->fetchNodes();
 }
 
@@ -5227,19 +5581,40 @@ void MegaApplication::onGlobalSyncStateChanged(MegaApi *)
     MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Current state. Paused = %1   Indexing = %2   Waiting = %3")
                  .arg(paused).arg(indexing).arg(waiting).toUtf8().constData());
 
+    //Syncs are resumed in batches, so the state can be up to date between them
+    if (megaApi && !indexing && !waiting && !StartupProfiler::instance()->isFinished()
+            && syncResumer && !syncResumer->isResuming()
+            && preferences->logged() && !megaApi->getNumPendingUploads() && !megaApi->getNumPendingDownloads())
+    {
+        MegaNode *rootNode = megaApi->getRootNode();
+        if (rootNode)
+        {
+            delete rootNode;
+
+            //First time up to date after the startup
+            StartupProfiler::instance()->mark(QString::fromUtf8("synced"));
+            StartupProfiler::instance()->finish();
+        }
+    }
+
     if (!isLinux)
     {
         updateTrayIcon();
     }
 }
 
-void MegaApplication::onSyncStateChanged(MegaApi *api, MegaSync *)
+void MegaApplication::onSyncStateChanged(MegaApi *api, MegaSync *sync)
 {
     if (appfinished)
     {
         return;
     }
 
+    if (syncResumer && sync)
+    {
+        syncResumer->onSyncStateChanged(sync->getMegaHandle(), sync->getState());
+    }
+
     onGlobalSyncStateChanged(api);
 }
 
@@ -5254,9 +5629,57 @@ void MegaApplication::onSyncFileStateChanged(MegaApi *, MegaSync *, const char *
     Platform::notifyItemChange(localPath);
 }
 
-MEGASyncDelegateListener::MEGASyncDelegateListener(MegaApi *megaApi, MegaListener *parent)
+MEGASyncDelegateListener::MEGASyncDelegateListener(MegaApi *megaApi, MegaListener *parent, SyncResumer *syncResumer)
     : QTMegaListener(megaApi, parent)
-{ }
+{
+    this->syncResumer = syncResumer;
+}
+
+MEGASyncDelegateListener::~MEGASyncDelegateListener()
+{
+    qDeleteAll(pendingUpdates);
+}
+
+void MEGASyncDelegateListener::onTransferUpdate(MegaApi *api, MegaTransfer *transfer)
+{
+    //Only one update event per transfer is kept in the event queue.
+    //Newer updates replace the state that it will deliver
+    pendingUpdatesMutex.lock();
+    QHash<int, MegaTransfer *>::iterator it = pendingUpdates.find(transfer->getTag());
+    if (it != pendingUpdates.end())
+    {
+        delete it.value();
+        it.value() = transfer->copy();
+        pendingUpdatesMutex.unlock();
+        return;
+    }
+    pendingUpdates.insert(transfer->getTag(), NULL);
+    pendingUpdatesMutex.unlock();
+
+    QTMegaListener::onTransferUpdate(api, transfer);
+}
+
+void MEGASyncDelegateListener::customEvent(QEvent *event)
+{
+    if (event->type() != QTMegaEvent::OnTransferUpdate)
+    {
+        QTMegaListener::customEvent(event);
+        return;
+    }
+
+    QTMegaEvent *megaEvent = (QTMegaEvent *)event;
+    MegaTransfer *transfer = megaEvent->getTransfer();
+
+    pendingUpdatesMutex.lock();
+    MegaTransfer *latest = pendingUpdates.take(transfer->getTag());
+    pendingUpdatesMutex.unlock();
+
+    if (listener)
+    {
+        listener->onTransferUpdate(megaEvent->getMegaApi(), latest ? latest : transfer);
+    }
+    delete latest;
+}
 
 void MEGASyncDelegateListener::onRequestFinish(MegaApi *api, MegaRequest *request, MegaError *e)
 {
@@ -5269,41 +5692,10 @@ void MEGASyncDelegateListener::onRequestFinish(MegaApi *api, MegaRequest *reques
     }
 
     Preferences *preferences = Preferences::instance();
-    if (preferences->logged() && !api->getNumActiveSyncs())
+    if (syncResumer && preferences->logged() && !api->getNumActiveSyncs())
     {
-        //Start syncs
-        for (int i = 0; i < preferences->getNumSyncedFolders(); i++)
-        {
-            QString tmpPath = preferences->getLocalFolder(i)
-                    + QDir::separator()
-                    + QString::fromUtf8(mega::MEGA_DEBRIS_FOLDER)
-                    + QString::fromUtf8("/tmp");
-            QDirIterator di(tmpPath, QDir::Files | QDir::NoDotAndDotDot);
-            while (di.hasNext())
-            {
-                di.next();
-                const QFileInfo& fi = di.fileInfo();
-                if (fi.fileName().endsWith(QString::fromAscii(".mega")))
-                {
-                    QFile::remove(di.filePath());
-                }
-            }
-
-            if (!preferences->isFolderActive(i))
-            {
-                continue;
-            }
-
-            MegaNode *node = api->getNodeByHandle(preferences->getMegaFolderHandle(i));
-            if (!node)
-            {
-                preferences->setSyncState(i, false);
-                continue;
-            }
-
-            QString localFolder = preferences->getLocalFolder(i);
-            api->resumeSync(localFolder.toUtf8().constData(), node, preferences->getLocalFingerprint(i));
-            delete node;
-        }
+        //The cleanup of temporary files and the staggered resume
+        //of the syncs don't block the thread of the SDK
+        QMetaObject::invokeMethod(syncResumer, "resumeSyncs", Qt::QueuedConnection);
     }
 }
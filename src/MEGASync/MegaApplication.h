@@ -10,6 +10,8 @@
 #include <QLocalSocket>
 #include <QDataStream>
 #include <QQueue>
+#include <QHash>
+#include <QMutex>
 #include <QNetworkConfigurationManager>
 #include <QNetworkInterface>
 
@@ -33,8 +35,16 @@
 #include "control/MegaDownloader.h"
 #include "control/UpdateTask.h"
 #include "control/MegaSyncLogger.h"
+#include "control/TransferStatistics.h"
+#include "control/NodeUpdateProcessor.h"
+#include "control/SyncRescanner.h"
+#include "control/ExclusionEvaluator.h"
+#include "control/ExclusionUploader.h"
+#include "control/SyncResumer.h"
+#include "control/DebrisTracker.h"
 #include "megaapi.h"
 #include "QTMegaListener.h"
+#include "QTMegaEvent.h"
 
 #ifdef __APPLE__
     #include "gui/MegaSystemTrayIcon.h"
@@ -60,6 +70,7 @@ public:
     static QString applicationDataPath();
     void changeLanguage(QString languageCode);
     void updateTrayIcon();
+    void updateTrayTooltip();
 
     virtual void onRequestStart(mega::MegaApi* api, mega::MegaRequest *request);
     virtual void onRequestFinish(mega::MegaApi* api, mega::MegaRequest *request, mega::MegaError* e);
@@ -78,6 +89,8 @@ public:
 
 
     mega::MegaApi *getMegaApi() { return megaApi; }
+    //Last measured upload speed (bytes per second), the upload limit if there isn't any or -1
+    long long getUploadRate();
 
     void unlink();
     void showInfoMessage(QString message, QString title = tr("MEGAsync"));
@@ -86,7 +99,6 @@ public:
     void showNotificationMessage(QString message, QString title = tr("MEGAsync"));
     void setUploadLimit(int limit);
     void setUseHttpsOnly(bool httpsOnly);
-    void startUpdateTask();
     void stopUpdateTask();
     void applyProxySettings();
     void updateUserStats();
@@ -94,6 +106,11 @@ public:
     void checkForUpdates();
     void showTrayMenu(QPoint *point = NULL);
     void toggleLogging();
+    void rescanSync(int syncId);
+    void repairSync(int syncId);
+    void repairSyncs(QList<int> syncIds);
+    bool isRescanningSync(int syncId);
+    void reevaluateExclusions(const ExclusionRules &oldRules);
 
 #if (QT_VERSION == 0x050500) && defined(_WIN32)
     bool eventFilter(QObject *o, QEvent * ev);
@@ -104,6 +121,7 @@ signals:
     void tryUpdate();
     void installUpdate();
     void unityFixSignal();
+    void nodesUpdated();
 
 public slots:
     void trayIconActivated(QSystemTrayIcon::ActivationReason reason);
@@ -143,6 +161,11 @@ public slots:
     void cleanAll();
     void onDupplicateLink(QString link, QString name, mega::MegaHandle handle);
     void onDupplicateTransfer(QString localPath, QString name, mega::MegaHandle handle, QString nodeKey = QString());
+    void onLocalCopyProgress(QString localPath, long long copiedBytes, long long totalBytes);
+    void onLocalCopyFinished(QString localPath, long long copiedBytes, long long clonedBytes, int numFiles, int numErrors);
+    void publishTransferStatistics();
+    void nodeUpdatesProcessed(const NodeUpdateSummary &summary);
+    void exclusionsEvaluated(const ExclusionEvaluation &evaluation);
     void onInstallUpdateClicked();
     void showInfoDialog();
     bool anUpdateIsAvailable();
@@ -159,6 +182,14 @@ public slots:
     void showUpdatedMessage();
     void handleMEGAurl(const QUrl &url);
     void handleLocalPath(const QUrl &url);
+    void startUpdateTask();
+
+protected slots:
+    void startHttpServer();
+    void onSyncRescanProgress(int syncId, long long numFolders, long long numFiles,
+                              int foldersPerSecond, int filesPerSecond);
+    void onSyncRescanFinished(int syncId, long long numFolders, long long numFiles,
+                              long long numMismatches, bool cancelled);
 
 protected:
     void createTrayIcon();
@@ -170,6 +201,7 @@ protected:
     void startSyncs();
     void processUploadQueue(mega::MegaHandle nodeHandle);
     void processDownloadQueue(QString path);
+    void requestPublicNode(QString megaLink);
     void unityFix();
     void disableSyncs();
     void restoreSyncs();
@@ -232,11 +264,19 @@ protected:
     MultiQFileDialog *multiUploadFileDialog;
     QQueue<QString> uploadQueue;
     QQueue<mega::MegaNode *> downloadQueue;
-    long long totalDownloadSize, totalUploadSize;
-    long long totalDownloadedSize, totalUploadedSize;
-    long long uploadSpeed, downloadSpeed;
-    long long lastStartedDownload;
-    long long lastStartedUpload;
+    TransferStatistics *transferStatistics;
+    NodeUpdateProcessor *nodeUpdateProcessor;
+    ExclusionEvaluator *exclusionEvaluator;
+    ExclusionUploader *exclusionUploader;
+    SyncResumer *syncResumer;
+    DebrisRetentionTask *debrisRetentionTask;
+    long long lastDebrisRetention;
+    long long measuredUploadRate;
+    QString trayTooltip;
+    //Copy into a synced folder shown in the info dialog
+    QString localCopyPath;
+    bool trayTooltipShowsEta;
+    QMap<int, SyncRescanner *> syncRescanners;
     int exportOps;
     int syncState;
     mega::MegaPricing *pricing;
@@ -252,6 +292,7 @@ protected:
     QTimer *periodicTasksTimer;
     QTimer *infoDialogTimer;
     QTranslator *translator;
+    QString currentLanguage;
     PasteMegaLinksDialog *pasteMegaLinksDialog;
     ChangeLogDialog *changeLogDialog;
     ImportMegaLinksDialog *importDialog;
@@ -296,8 +337,19 @@ protected:
 class MEGASyncDelegateListener: public mega::QTMegaListener
 {
 public:
-    MEGASyncDelegateListener(mega::MegaApi *megaApi, mega::MegaListener *parent=NULL);
+    MEGASyncDelegateListener(mega::MegaApi *megaApi, mega::MegaListener *parent=NULL, SyncResumer *syncResumer=NULL);
+    virtual ~MEGASyncDelegateListener();
     virtual void onRequestFinish(mega::MegaApi* api, mega::MegaRequest *request, mega::MegaError* e);
+    virtual void onTransferUpdate(mega::MegaApi *api, mega::MegaTransfer *transfer);
+
+protected:
+    virtual void customEvent(QEvent *event);
+
+    //Latest state of the transfers with an update event waiting in the event queue.
+    //A NULL value means that the state carried by the queued event is still the latest one
+    QMutex pendingUpdatesMutex;
+    QHash<int, mega::MegaTransfer *> pendingUpdates;
+    SyncResumer *syncResumer;
 };
 
 #endif // MEGAAPPLICATION_H
@@ -0,0 +1,427 @@
+#include "DebrisTracker.h"
+#include "Utilities.h"
+#include "FileSystemWalker.h"
+#include "megaapi.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+
+using namespace mega;
+
+static const quint32 DEBRIS_CHECKPOINT_VERSION = 1;
+
+DebrisEntry::DebrisEntry()
+{
+    modificationTime = 0;
+    size = 0;
+    numFiles = 0;
+}
+
+DebrisSyncState::DebrisSyncState()
+{
+    size = 0;
+    numFiles = 0;
+}
+
+DebrisTracker *DebrisTracker::instance()
+{
+    static DebrisTracker globalTracker;
+    return &globalTracker;
+}
+
+//Stops a walk of the debris when the tracker is cancelled
+class DebrisWalkVisitor : public FileSystemVisitor
+{
+public:
+    explicit DebrisWalkVisitor(QAtomicInt *cancelled) : walker(NULL), cancelled(cancelled) {}
+
+    void visit(const QString &, const QString &, bool, long long)
+    {
+        if (*cancelled)
+        {
+            walker->cancel();
+        }
+    }
+
+    FileSystemWalker *walker;
+
+protected:
+    QAtomicInt *cancelled;
+};
+
+DebrisTracker::DebrisTracker()
+{
+    cancelled = 0;
+}
+
+QString DebrisTracker::debrisPath(QString localFolder)
+{
+    return localFolder + QDir::separator() + QString::fromAscii(MEGA_DEBRIS_FOLDER);
+}
+
+void DebrisTracker::load(QString checkpointFile)
+{
+    QMutexLocker locker(&mutex);
+    this->checkpointFile = checkpointFile;
+    syncs.clear();
+
+    QFile file(checkpointFile);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QDataStream dataStream(&file);
+    dataStream.setVersion(QDataStream::Qt_4_6);
+
+    quint32 version = 0;
+    quint32 numSyncs = 0;
+    dataStream >> version >> numSyncs;
+    if (version != DEBRIS_CHECKPOINT_VERSION)
+    {
+        return;
+    }
+
+    QMap<QString, DebrisSyncState> checkpoint;
+    for (quint32 i = 0; i < numSyncs && dataStream.status() == QDataStream::Ok; i++)
+    {
+        QString localFolder;
+        quint32 numEntries = 0;
+        dataStream >> localFolder >> numEntries;
+
+        DebrisSyncState state;
+        for (quint32 j = 0; j < numEntries && dataStream.status() == QDataStream::Ok; j++)
+        {
+            QString name;
+            qint64 modificationTime, size, numFiles;
+            dataStream >> name >> modificationTime >> size >> numFiles;
+
+            DebrisEntry entry;
+            entry.modificationTime = modificationTime;
+            entry.size = size;
+            entry.numFiles = numFiles;
+            state.entries.insert(name, entry);
+            state.size += size;
+            state.numFiles += numFiles;
+        }
+        checkpoint.insert(localFolder, state);
+    }
+
+    if (dataStream.status() != QDataStream::Ok)
+    {
+        MegaApi::log(MegaApi::LOG_LEVEL_WARNING, "Invalid debris checkpoint. Debris folders will be walked again");
+        return;
+    }
+
+    syncs = checkpoint;
+}
+
+void DebrisTracker::save()
+{
+    if (checkpointFile.isEmpty())
+    {
+        return;
+    }
+
+    QByteArray contents;
+    QDataStream dataStream(&contents, QIODevice::WriteOnly);
+    dataStream.setVersion(QDataStream::Qt_4_6);
+    dataStream << DEBRIS_CHECKPOINT_VERSION << (quint32)syncs.size();
+    for (QMap<QString, DebrisSyncState>::const_iterator it = syncs.constBegin(); it != syncs.constEnd(); ++it)
+    {
+        const QMap<QString, DebrisEntry> &entries = it.value().entries;
+        dataStream << it.key() << (quint32)entries.size();
+        for (QMap<QString, DebrisEntry>::const_iterator entry = entries.constBegin(); entry != entries.constEnd(); ++entry)
+        {
+            dataStream << entry.key() << (qint64)entry.value().modificationTime
+                       << (qint64)entry.value().size << (qint64)entry.value().numFiles;
+        }
+    }
+
+    //Write a new file and replace the previous one, so a crash
+    //in the middle of a write doesn't leave a truncated checkpoint
+    QString tmpFile = checkpointFile + QString::fromAscii(".tmp");
+    QFile file(tmpFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+            || file.write(contents) != contents.size())
+    {
+        file.close();
+        QFile::remove(tmpFile);
+        return;
+    }
+    file.close();
+
+    QFile::remove(checkpointFile);
+    QFile::rename(tmpFile, checkpointFile);
+}
+
+long long DebrisTracker::refresh(QStringList localFolders)
+{
+    bool changed = false;
+    mutex.lock();
+    QStringList trackedFolders = syncs.keys();
+    for (int i = 0; i < trackedFolders.size(); i++)
+    {
+        if (!localFolders.contains(trackedFolders[i]))
+        {
+            syncs.remove(trackedFolders[i]);
+            changed = true;
+        }
+    }
+    mutex.unlock();
+
+    for (int i = 0; i < localFolders.size() && !cancelled; i++)
+    {
+        if (!localFolders[i].isEmpty() && refreshSync(localFolders[i]))
+        {
+            changed = true;
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    if (changed)
+    {
+        save();
+    }
+
+    long long totalSize = 0;
+    for (QMap<QString, DebrisSyncState>::const_iterator it = syncs.constBegin(); it != syncs.constEnd(); ++it)
+    {
+        totalSize += it.value().size;
+    }
+    return totalSize;
+}
+
+bool DebrisTracker::refreshSync(QString localFolder)
+{
+    mutex.lock();
+    DebrisSyncState previousState = syncs.value(localFolder);
+    mutex.unlock();
+
+    QString today = QDate::currentDate().toString(QString::fromAscii("yyyy-MM-dd"));
+    bool changed = false;
+    DebrisSyncState state;
+
+    //The walk is done without the lock, entries are only walked
+    //again when they are modified or while the SDK can still write in them
+    QDir debris(debrisPath(localFolder));
+    QFileInfoList entries = debris.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
+    for (int i = 0; i < entries.size(); i++)
+    {
+        QFileInfo info = entries[i];
+        QString name = info.fileName();
+
+        DebrisEntry entry;
+        entry.modificationTime = info.lastModified().toMSecsSinceEpoch();
+        if (previousState.entries.contains(name)
+                && previousState.entries[name].modificationTime == entry.modificationTime
+                && name != today && info.isDir() && name != QString::fromAscii("tmp"))
+        {
+            entry = previousState.entries[name];
+        }
+        else if (info.isDir())
+        {
+            //Incomplete sizes are discarded, the previous counters are kept
+            if (!walk(info.absoluteFilePath(), &entry.size, &entry.numFiles))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            entry.size = info.size();
+            entry.numFiles = 1;
+        }
+
+        if (!previousState.entries.contains(name)
+                || previousState.entries[name].size != entry.size
+                || previousState.entries[name].numFiles != entry.numFiles
+                || previousState.entries[name].modificationTime != entry.modificationTime)
+        {
+            changed = true;
+        }
+
+        state.entries.insert(name, entry);
+        state.size += entry.size;
+        state.numFiles += entry.numFiles;
+    }
+
+    if (state.entries.size() != previousState.entries.size())
+    {
+        changed = true;
+    }
+
+    QMutexLocker locker(&mutex);
+    syncs.insert(localFolder, state);
+    return changed;
+}
+
+long long DebrisTracker::applyRetention(QString localFolder, int maxAgeDays, long long maxSize)
+{
+    if ((maxAgeDays <= 0 && maxSize <= 0) || cancelled)
+    {
+        return 0;
+    }
+
+    mutex.lock();
+    DebrisSyncState state = syncs.value(localFolder);
+    mutex.unlock();
+
+    //Entries are sorted by name, so day folders are sorted from the oldest to the newest
+    QDate today = QDate::currentDate();
+    QStringList removedEntries;
+    long long remainingSize = state.size;
+    for (QMap<QString, DebrisEntry>::const_iterator it = state.entries.constBegin(); it != state.entries.constEnd(); ++it)
+    {
+        //Folders created on name clashes are named "yyyy-MM-dd HH.mm.ss.NN"
+        QDate date = QDate::fromString(it.key().left(10), QString::fromAscii("yyyy-MM-dd"));
+        if (!date.isValid() || date >= today)
+        {
+            continue;
+        }
+
+        if ((maxAgeDays > 0 && date.daysTo(today) > maxAgeDays)
+                || (maxSize > 0 && remainingSize > maxSize))
+        {
+            removedEntries.append(it.key());
+            remainingSize -= it.value().size;
+        }
+    }
+
+    if (removedEntries.isEmpty())
+    {
+        return 0;
+    }
+
+    long long freedBytes = 0;
+    long long freedFiles = 0;
+    QString debris = debrisPath(localFolder);
+    for (int i = 0; i < removedEntries.size() && !cancelled; i++)
+    {
+        QString path = debris + QDir::separator() + removedEntries[i];
+        if (Utilities::removeRecursively(path) || !QFileInfo(path).exists())
+        {
+            freedBytes += state.entries[removedEntries[i]].size;
+            freedFiles += state.entries[removedEntries[i]].numFiles;
+            state.entries.remove(removedEntries[i]);
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    if (syncs.contains(localFolder))
+    {
+        DebrisSyncState &current = syncs[localFolder];
+        for (int i = 0; i < removedEntries.size(); i++)
+        {
+            if (!state.entries.contains(removedEntries[i]) && current.entries.contains(removedEntries[i]))
+            {
+                DebrisEntry entry = current.entries.take(removedEntries[i]);
+                current.size -= entry.size;
+                current.numFiles -= entry.numFiles;
+            }
+        }
+    }
+    save();
+
+    MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Debris retention: %1 files (%2 bytes) removed from %3")
+                 .arg(freedFiles).arg(freedBytes).arg(localFolder).toUtf8().constData());
+    return freedBytes;
+}
+
+void DebrisTracker::clear(QString localFolder)
+{
+    QMutexLocker locker(&mutex);
+    if (syncs.contains(localFolder))
+    {
+        syncs.insert(localFolder, DebrisSyncState());
+        save();
+    }
+}
+
+void DebrisTracker::cancel()
+{
+    cancelled = 1;
+}
+
+bool DebrisTracker::isCancelled()
+{
+    return cancelled;
+}
+
+long long DebrisTracker::getTotalSize()
+{
+    QMutexLocker locker(&mutex);
+    long long totalSize = 0;
+    for (QMap<QString, DebrisSyncState>::const_iterator it = syncs.constBegin(); it != syncs.constEnd(); ++it)
+    {
+        totalSize += it.value().size;
+    }
+    return totalSize;
+}
+
+long long DebrisTracker::getTotalFiles()
+{
+    QMutexLocker locker(&mutex);
+    long long totalFiles = 0;
+    for (QMap<QString, DebrisSyncState>::const_iterator it = syncs.constBegin(); it != syncs.constEnd(); ++it)
+    {
+        totalFiles += it.value().numFiles;
+    }
+    return totalFiles;
+}
+
+long long DebrisTracker::getSize(QString localFolder)
+{
+    QMutexLocker locker(&mutex);
+    return syncs.value(localFolder).size;
+}
+
+bool DebrisTracker::walk(QString path, long long *size, long long *numFiles)
+{
+    DebrisWalkVisitor visitor(&cancelled);
+    FileSystemWalker walker(FileSystemWalker::WALK_SIZES, &visitor);
+    visitor.walker = &walker;
+    if (cancelled || !walker.walk(path) || cancelled)
+    {
+        return false;
+    }
+
+    (*size) += walker.getTotalSize();
+    (*numFiles) += walker.getNumFiles();
+    return true;
+}
+
+DebrisRetentionTask::DebrisRetentionTask(QObject *parent) : QThread(parent)
+{
+    maxAgeDays = 0;
+    maxSize = 0;
+    freedBytes = 0;
+}
+
+void DebrisRetentionTask::setPolicy(QStringList localFolders, int maxAgeDays, long long maxSize)
+{
+    this->localFolders = localFolders;
+    this->maxAgeDays = maxAgeDays;
+    this->maxSize = maxSize;
+}
+
+long long DebrisRetentionTask::getFreedBytes()
+{
+    return freedBytes;
+}
+
+void DebrisRetentionTask::run()
+{
+    freedBytes = 0;
+    DebrisTracker *tracker = DebrisTracker::instance();
+    tracker->refresh(localFolders);
+    for (int i = 0; i < localFolders.size() && !tracker->isCancelled(); i++)
+    {
+        if (!localFolders[i].isEmpty())
+        {
+            freedBytes += tracker->applyRetention(localFolders[i], maxAgeDays, maxSize);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef DEBRISTRACKER_H
+#define DEBRISTRACKER_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QMutex>
+#include <QThread>
+#include <QAtomicInt>
+
+//Size of an entry of the root of a local debris folder.
+//The SDK creates one folder per day ("yyyy-MM-dd"), folders for name clashes
+//("yyyy-MM-dd HH.mm.ss.NN") and "tmp"
+class DebrisEntry
+{
+public:
+    DebrisEntry();
+
+    long long modificationTime;
+    long long size;
+    long long numFiles;
+};
+
+class DebrisSyncState
+{
+public:
+    DebrisSyncState();
+
+    QMap<QString, DebrisEntry> entries;
+    long long size;
+    long long numFiles;
+};
+
+//Running counters of the size of the local debris folders of the syncs.
+//The sizes are checkpointed to disk, so a refresh only walks the entries of the
+//debris folders that are new or have been modified since the previous one
+//(today's folder and the temporary folder, in practice) instead of walking
+//every debris folder each time the size is needed. Thread safe
+class DebrisTracker
+{
+public:
+    static DebrisTracker *instance();
+
+    //Loads the checkpoint. The counters are discarded if it can't be read
+    void load(QString checkpointFile);
+    //Updates the counters of the syncs and forgets the syncs not included in the list.
+    //Returns the total size
+    long long refresh(QStringList localFolders);
+    //Removes the debris of a sync older than maxAgeDays and the oldest ones while the
+    //total size is over maxSize. A value of 0 disables each limit.
+    //Today's folder and the temporary folder are never removed.
+    //Uses the counters of the last refresh. Returns the freed bytes
+    long long applyRetention(QString localFolder, int maxAgeDays, long long maxSize);
+    //Must be called after removing the whole debris folder of a sync
+    void clear(QString localFolder);
+    //Stops the walks and removals in progress and skips the next ones.
+    //Used on exit, can be called from any thread
+    void cancel();
+    bool isCancelled();
+
+    long long getTotalSize();
+    long long getTotalFiles();
+    long long getSize(QString localFolder);
+
+    static QString debrisPath(QString localFolder);
+
+protected:
+    DebrisTracker();
+
+    bool refreshSync(QString localFolder);
+    void save();
+    bool walk(QString path, long long *size, long long *numFiles);
+
+    QMutex mutex;
+    QAtomicInt cancelled;
+    QMap<QString, DebrisSyncState> syncs;
+    QString checkpointFile;
+};
+
+//Applies the retention policy of the preferences to the debris of all the syncs
+//in a thread with the lowest priority
+class DebrisRetentionTask : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit DebrisRetentionTask(QObject *parent = 0);
+
+    //Must be called before starting the thread
+    void setPolicy(QStringList localFolders, int maxAgeDays, long long maxSize);
+    long long getFreedBytes();
+
+protected:
+    void run();
+
+    QStringList localFolders;
+    int maxAgeDays;
+    long long maxSize;
+    long long freedBytes;
+};
+
+#endif // DEBRISTRACKER_H
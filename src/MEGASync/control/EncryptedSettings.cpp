@@ -1,79 +1,163 @@
+#include "mega.h"
 #include "EncryptedSettings.h"
 #include "platform/Platform.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QUuid>
 
-EncryptedSettings::EncryptedSettings(QString file) :
-    QSettings(file, QSettings::IniFormat)
+#ifdef WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#include <stdio.h>
+#endif
+
+using mega::SymmCipher;
+
+const QByteArray EncryptedSettings::BLOB_MAGIC = QByteArray("MEGACFG");
+const char EncryptedSettings::BLOB_VERSION = 1;
+
+static const int BLOB_IV_SIZE = 12;
+static const int BLOB_TAG_SIZE = 16;
+
+EncryptedSettings::EncryptedSettings(QString file, int format)
 {
     QByteArray fixedSeed("$JY/X?o=h·&%v/M(");
     QByteArray localKey = Platform::getLocalStorageKey();
     QByteArray xLocalKey = XOR(fixedSeed, localKey);
     QByteArray hLocalKey = QCryptographicHash::hash(xLocalKey, QCryptographicHash::Sha1);
     encryptionKey = hLocalKey;
+    blobKey = QCryptographicHash::hash(encryptionKey + QByteArray("blob"), QCryptographicHash::Sha1)
+            .left(SymmCipher::KEYLENGTH);
+
+    this->format = format;
+    fileName = file;
+    iniSettings = NULL;
+    dirty = false;
+    iniRewriteNeeded = false;
+
+    if (format == FORMAT_BLOB)
+    {
+        QFile blobFile(blobFileName(fileName));
+        if (blobFile.open(QIODevice::ReadOnly))
+        {
+            QByteArray contents = blobFile.readAll();
+            blobFile.close();
+            if (loadBlob(contents))
+            {
+                return;
+            }
+        }
+    }
+
+    if (loadIniFile() && format == FORMAT_BLOB)
+    {
+        //The blob is created with the next sync
+        dirty = true;
+    }
+}
+
+EncryptedSettings::~EncryptedSettings()
+{
+    delete iniSettings;
 }
 
 void EncryptedSettings::setValue(const QString &key, const QVariant &value)
 {
-    QSettings::setValue(hash(key), encrypt(key, value.toString()));
+    QString path = fullPath(hash(key));
+    values.insert(path, value.toString());
+    markChanged(path);
 }
 
 QVariant EncryptedSettings::value(const QString &key, const QVariant &defaultValue)
 {
-    return QVariant(decrypt(key, QSettings::value(hash(key), encrypt(key, defaultValue.toString())).toString()));
+    QMap<QString, QString>::const_iterator it = values.constFind(fullPath(hash(key)));
+    if (it == values.constEnd())
+    {
+        return QVariant(defaultValue.toString());
+    }
+    return QVariant(it.value());
 }
 
 void EncryptedSettings::beginGroup(const QString &prefix)
 {
-    QSettings::beginGroup(hash(prefix));
+    groups.append(hash(prefix));
 }
 
 void EncryptedSettings::beginGroup(int numGroup)
 {
-     QSettings::beginGroup(QSettings::childGroups().at(numGroup));
+    groups.append(childGroups().at(numGroup));
 }
 
 void EncryptedSettings::endGroup()
 {
-    QSettings::endGroup();
+    if (groups.size())
+    {
+        groups.removeLast();
+    }
 }
 
 int EncryptedSettings::numChildGroups()
 {
-    return QSettings::childGroups().size();
+    return childGroups().size();
 }
 
 bool EncryptedSettings::containsGroup(QString groupName)
 {
-    return QSettings::childGroups().contains(hash(groupName));
+    return childGroups().contains(hash(groupName));
 }
 
 bool EncryptedSettings::isGroupEmpty()
 {
-    return QSettings::group().isEmpty();
+    return groups.isEmpty();
 }
 
 void EncryptedSettings::remove(const QString &key)
 {
     if (!key.length())
     {
-        QSettings::remove(QString::fromAscii(""));
+        removeGroup(group());
     }
     else
     {
-        QSettings::remove(hash(key));
+        //The key could also be the name of a group
+        QString path = fullPath(hash(key));
+        values.remove(path);
+        markChanged(path);
+        removeGroup(path);
     }
+    dirty = true;
 }
 
 void EncryptedSettings::clear()
 {
-    QSettings::clear();
+    values.clear();
+    iniRewriteNeeded = true;
+    dirty = true;
 }
 
 void EncryptedSettings::sync()
 {
-    QSettings::sync();
+    if (!dirty)
+    {
+        return;
+    }
 
-    QFile::remove(this->fileName().append(QString::fromUtf8(".bak")));
-    QFile::copy(this->fileName(),this->fileName().append(QString::fromUtf8(".bak")));
+    //The INI file is written first, so a blob is never older than it
+    writeIniFile();
+    if (format == FORMAT_BLOB && !writeFile(blobFileName(fileName), createBlob()))
+    {
+        return;
+    }
+    dirty = false;
+}
+
+QString EncryptedSettings::blobFileName(QString file)
+{
+    return file + QString::fromAscii(".blob");
 }
 
 //Simplified XOR fun
@@ -85,52 +169,345 @@ QByteArray EncryptedSettings::XOR(const QByteArray& key, const QByteArray& data)
         return data;
     }
 
+    int dataLen = data.length();
     QByteArray result;
+    result.resize(dataLen);
+    char *output = result.data();
+    const char *input = data.constData();
+    const char *keyData = key.constData();
+
+    //Expand the key stream first so that the XOR itself is a plain loop
+    //over contiguous buffers, which the compiler can vectorize
     int rotation = abs(key[keyLen/3]*key[keyLen/5])%keyLen;
     int increment = abs(key[keyLen/2]*key[keyLen/7])%keyLen;
-    for (int i = 0, j = rotation; i < data.length(); i++, j -= increment)
+    for (int i = 0, j = rotation; i < dataLen; i++, j -= increment)
     {
         if (j < 0)
         {
             j += keyLen;
         }
-        result.append(data[i] ^ key[j]);
+        output[i] = keyData[j];
+    }
+
+    for (int i = 0; i < dataLen; i++)
+    {
+        output[i] ^= input[i];
     }
     return result;
 }
 
-QString EncryptedSettings::encrypt(const QString key, const QString value) const
+QString EncryptedSettings::encrypt(const QString hashedKey, const QString groupPath, const QString value) const
 {
     if (value.isEmpty())
     {
         return value;
     }
 
-    QByteArray k = hash(key).toAscii();
+    QByteArray k = hashedKey.toAscii();
     QByteArray xValue = XOR(k, value.toUtf8());
-    QByteArray xKey = XOR(k, group().toAscii());
+    QByteArray xKey = XOR(k, groupPath.toAscii());
     QByteArray xEncrypted = XOR(k, Platform::encrypt(xValue, xKey));
     return QString::fromAscii(xEncrypted.toBase64());
 }
 
-QString EncryptedSettings::decrypt(const QString key, const QString value) const
+//hashedKey and groupPath are the names used in the INI file
+QString EncryptedSettings::decrypt(const QString hashedKey, const QString groupPath, const QString value) const
 {
     if (value.isEmpty())
     {
         return value;
     }
 
-    QByteArray k = hash(key).toAscii();
+    QByteArray k = hashedKey.toAscii();
     QByteArray xValue = XOR(k, QByteArray::fromBase64(value.toAscii()));
-    QByteArray xKey = XOR(k, group().toAscii());
+    QByteArray xKey = XOR(k, groupPath.toAscii());
     QByteArray xDecrypted = XOR(k, Platform::decrypt(xValue, xKey));
     return QString::fromUtf8(xDecrypted);
 }
 
 QString EncryptedSettings::hash(const QString key) const
 {
+    //The result only depends on the key and the current group, so it's memoized
+    QString path = group() + QString::fromAscii("/") + key;
+    QHash<QString, QString>::const_iterator it = hashCache.constFind(path);
+    if (it != hashCache.constEnd())
+    {
+        return it.value();
+    }
+
     QByteArray xPath = XOR(encryptionKey, (key+group()).toUtf8());
     QByteArray keyHash = QCryptographicHash::hash(xPath, QCryptographicHash::Sha1);
     QByteArray xKeyHash = XOR(key.toUtf8(), keyHash);
-    return QString::fromAscii(xKeyHash.toHex());
+    QString result = QString::fromAscii(xKeyHash.toHex());
+    hashCache.insert(path, result);
+    return result;
+}
+
+QString EncryptedSettings::group() const
+{
+    return groups.join(QString::fromAscii("/"));
+}
+
+QString EncryptedSettings::fullPath(const QString &hashedKey) const
+{
+    if (groups.isEmpty())
+    {
+        return hashedKey;
+    }
+    return group() + QString::fromAscii("/") + hashedKey;
+}
+
+QStringList EncryptedSettings::childGroups() const
+{
+    QStringList result;
+    QString prefix = groups.isEmpty() ? QString() : group() + QString::fromAscii("/");
+    QMap<QString, QString>::const_iterator it = values.lowerBound(prefix);
+    while (it != values.constEnd() && it.key().startsWith(prefix))
+    {
+        int separator = it.key().indexOf(QChar::fromAscii('/'), prefix.size());
+        if (separator < 0)
+        {
+            it++;
+            continue;
+        }
+
+        //Skip the rest of the entries of the group ('0' follows '/')
+        QString childGroup = it.key().mid(prefix.size(), separator - prefix.size());
+        result.append(childGroup);
+        it = values.lowerBound(prefix + childGroup + QString::fromAscii("0"));
+    }
+    return result;
+}
+
+void EncryptedSettings::removeGroup(const QString &path)
+{
+    if (path.isEmpty())
+    {
+        clear();
+        return;
+    }
+
+    removedGroups.insert(path);
+
+    QString prefix = path + QString::fromAscii("/");
+    QMap<QString, QString>::iterator it = values.lowerBound(prefix);
+    while (it != values.end() && it.key().startsWith(prefix))
+    {
+        it = values.erase(it);
+    }
+}
+
+void EncryptedSettings::markChanged(const QString &path)
+{
+    changedPaths.insert(path);
+    dirty = true;
+}
+
+bool EncryptedSettings::loadIniFile()
+{
+    iniSettings = new QSettings(fileName, QSettings::IniFormat);
+    if (iniSettings->status() != QSettings::NoError)
+    {
+        return false;
+    }
+
+    QStringList keys = iniSettings->allKeys();
+    for (int i = 0; i < keys.size(); i++)
+    {
+        QString path = keys.at(i);
+        int separator = path.lastIndexOf(QChar::fromAscii('/'));
+        QString groupPath = separator < 0 ? QString() : path.left(separator);
+        QString hashedKey = path.mid(separator + 1);
+        values.insert(path, decrypt(hashedKey, groupPath, iniSettings->value(path).toString()));
+    }
+    return keys.size() > 0;
+}
+
+//Only the entries changed since the previous sync are encrypted again
+void EncryptedSettings::writeIniFile()
+{
+    if (!iniSettings)
+    {
+        iniSettings = new QSettings(fileName, QSettings::IniFormat);
+    }
+
+    if (iniRewriteNeeded)
+    {
+        iniSettings->clear();
+        removedGroups.clear();
+        changedPaths = QSet<QString>::fromList(values.keys());
+        iniRewriteNeeded = false;
+    }
+
+    for (QSet<QString>::const_iterator it = removedGroups.constBegin(); it != removedGroups.constEnd(); ++it)
+    {
+        iniSettings->remove(*it);
+    }
+
+    for (QSet<QString>::const_iterator it = changedPaths.constBegin(); it != changedPaths.constEnd(); ++it)
+    {
+        const QString &path = *it;
+        QMap<QString, QString>::const_iterator value = values.constFind(path);
+        if (value == values.constEnd())
+        {
+            iniSettings->remove(path);
+            continue;
+        }
+
+        int separator = path.lastIndexOf(QChar::fromAscii('/'));
+        QString groupPath = separator < 0 ? QString() : path.left(separator);
+        QString hashedKey = path.mid(separator + 1);
+        iniSettings->setValue(path, encrypt(hashedKey, groupPath, value.value()));
+    }
+    removedGroups.clear();
+    changedPaths.clear();
+
+    iniSettings->sync();
+
+    //The backup is replaced atomically, so there is always a complete copy
+    QFile file(fileName);
+    if (iniSettings->status() == QSettings::NoError && file.open(QIODevice::ReadOnly))
+    {
+        QByteArray contents = file.readAll();
+        file.close();
+        writeFile(fileName + QString::fromUtf8(".bak"), contents);
+    }
+}
+
+//Blob format:
+//BLOB_MAGIC | BLOB_VERSION | IV | AES-GCM encrypted payload and tag
+//The payload has the size and the modification time of the INI file when the blob
+//was written and the values. If the INI file changes, the blob is outdated
+bool EncryptedSettings::loadBlob(const QByteArray &blob)
+{
+    int headerSize = BLOB_MAGIC.size() + 1;
+    if (!blob.startsWith(BLOB_MAGIC)
+            || blob.size() < headerSize + BLOB_IV_SIZE + BLOB_TAG_SIZE
+            || blob.at(BLOB_MAGIC.size()) != BLOB_VERSION)
+    {
+        return false;
+    }
+
+    std::string encrypted(blob.constData() + headerSize + BLOB_IV_SIZE, blob.size() - headerSize - BLOB_IV_SIZE);
+    std::string payload;
+    SymmCipher cipher;
+    cipher.setkey((const mega::byte *)blobKey.constData());
+    try
+    {
+        cipher.gcm_decrypt(&encrypted, (const mega::byte *)blob.constData() + headerSize,
+                           BLOB_IV_SIZE, BLOB_TAG_SIZE, &payload);
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    //Authentication errors are reported with an exception or with an empty result.
+    //A valid payload is never empty
+    if (payload.empty())
+    {
+        return false;
+    }
+
+    QByteArray data = QByteArray::fromRawData(payload.data(), int(payload.size()));
+    QDataStream dataStream(data);
+    dataStream.setVersion(QDataStream::Qt_4_6);
+    qint64 iniSize, iniModificationTime;
+    QMap<QString, QString> loadedValues;
+    dataStream >> iniSize >> iniModificationTime >> loadedValues;
+    if (dataStream.status() != QDataStream::Ok)
+    {
+        return false;
+    }
+
+    long long currentSize, currentModificationTime;
+    getIniFileState(&currentSize, &currentModificationTime);
+    if (currentSize >= 0 && (currentSize != iniSize || currentModificationTime != iniModificationTime))
+    {
+        return false;
+    }
+
+    values = loadedValues;
+    if (currentSize < 0)
+    {
+        //The fallback is missing, it's written again with the next sync
+        iniRewriteNeeded = true;
+        dirty = true;
+    }
+    return true;
+}
+
+QByteArray EncryptedSettings::createBlob() const
+{
+    long long iniSize, iniModificationTime;
+    getIniFileState(&iniSize, &iniModificationTime);
+
+    QByteArray data;
+    QDataStream dataStream(&data, QIODevice::WriteOnly);
+    dataStream.setVersion(QDataStream::Qt_4_6);
+    dataStream << (qint64)iniSize << (qint64)iniModificationTime << values;
+
+    QByteArray iv = QUuid::createUuid().toRfc4122().left(BLOB_IV_SIZE);
+    std::string payload(data.constData(), data.size());
+    std::string encrypted;
+    SymmCipher cipher;
+    cipher.setkey((const mega::byte *)blobKey.constData());
+    cipher.gcm_encrypt(&payload, (const mega::byte *)iv.constData(), BLOB_IV_SIZE, BLOB_TAG_SIZE, &encrypted);
+
+    QByteArray blob;
+    blob.reserve(BLOB_MAGIC.size() + 1 + iv.size() + int(encrypted.size()));
+    blob.append(BLOB_MAGIC);
+    blob.append(BLOB_VERSION);
+    blob.append(iv);
+    blob.append(encrypted.data(), int(encrypted.size()));
+    return blob;
+}
+
+void EncryptedSettings::getIniFileState(long long *size, long long *modificationTime) const
+{
+    QFileInfo info(fileName);
+    if (!info.exists())
+    {
+        *size = -1;
+        *modificationTime = -1;
+        return;
+    }
+
+    *size = info.size();
+    *modificationTime = info.lastModified().toMSecsSinceEpoch();
+}
+
+//The file is written to a temporary file and renamed over the previous one,
+//so there is always a complete file even if the process dies while writing
+bool EncryptedSettings::writeFile(const QString &path, const QByteArray &contents)
+{
+    QString tmpFile = path + QString::fromUtf8(".tmp");
+    QFile target(tmpFile);
+    if (!target.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    if (target.write(contents) != contents.size() || !target.flush())
+    {
+        target.close();
+        QFile::remove(tmpFile);
+        return false;
+    }
+
+#ifdef WIN32
+    FlushFileBuffers((HANDLE)_get_osfhandle(target.handle()));
+    target.close();
+    if (!MoveFileExW((LPCWSTR)tmpFile.utf16(), (LPCWSTR)path.utf16(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+#else
+    fsync(target.handle());
+    target.close();
+    if (rename(QFile::encodeName(tmpFile).constData(), QFile::encodeName(path).constData()))
+#endif
+    {
+        QFile::remove(tmpFile);
+        return false;
+    }
+    return true;
 }
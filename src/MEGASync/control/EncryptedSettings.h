@@ -1,17 +1,34 @@
 #ifndef ENCRYPTEDSETTINGS_H
 #define ENCRYPTEDSETTINGS_H
 
-#include <QSettings>
+#include <QString>
 #include <QVariant>
 #include <QStringList>
 #include <QCryptographicHash>
+#include <QSettings>
+#include <QHash>
+#include <QMap>
+#include <QSet>
 
-class EncryptedSettings : protected QSettings
+//Encrypted key-value store with groups.
+//All the values are kept in memory, in plain form, by their hashed path.
+//There are two storage formats:
+// - FORMAT_INI: an INI file with a hashed key and an encrypted value per entry.
+//   It's the format that previous versions can read.
+// - FORMAT_BLOB: the INI file is still written as a fallback, but the values are
+//   loaded from a single blob encrypted with AES-GCM, so loading the settings
+//   doesn't depend on the number of keys. If the INI file was modified after the
+//   blob (for example by a previous version), the INI file is loaded instead.
+class EncryptedSettings
 {
-    Q_OBJECT
-
 public:
-    explicit EncryptedSettings(QString file);
+    enum {
+        FORMAT_INI = 0,
+        FORMAT_BLOB
+    };
+
+    explicit EncryptedSettings(QString file, int format = FORMAT_BLOB);
+    ~EncryptedSettings();
 
     void setValue(const QString & key, const QVariant & value);
     QVariant value(const QString & key, const QVariant & defaultValue = QVariant());
@@ -25,12 +42,47 @@ public:
     void clear();
     void sync();
 
+    static QString blobFileName(QString file);
+
+    static const QByteArray BLOB_MAGIC;
+    static const char BLOB_VERSION;
+
 protected:
     QByteArray XOR(const QByteArray &key, const QByteArray& data) const;
-    QString encrypt(const QString key, const QString value) const;
-    QString decrypt(const QString key, const QString value) const;
+    QString encrypt(const QString hashedKey, const QString groupPath, const QString value) const;
+    QString decrypt(const QString hashedKey, const QString groupPath, const QString value) const;
     QString hash(const QString key) const;
+    QString group() const;
+    QString fullPath(const QString &hashedKey) const;
+    QStringList childGroups() const;
+    void removeGroup(const QString &path);
+    void markChanged(const QString &path);
+
+    bool loadIniFile();
+    void writeIniFile();
+    bool loadBlob(const QByteArray &blob);
+    QByteArray createBlob() const;
+    void getIniFileState(long long *size, long long *modificationTime) const;
+    static bool writeFile(const QString &path, const QByteArray &contents);
+
+    int format;
+    QString fileName;
+    QSettings *iniSettings;
     QByteArray encryptionKey;
+    QByteArray blobKey;
+
+    //Plain values, by hashed path (hashed groups and hashed key separated by '/')
+    QMap<QString, QString> values;
+    QStringList groups;
+    bool dirty;
+
+    //Changes pending to be written to the INI file
+    QSet<QString> changedPaths;
+    QSet<QString> removedGroups;
+    bool iniRewriteNeeded;
+
+    //Hashed keys, by group and plain key
+    mutable QHash<QString, QString> hashCache;
 };
 
 #endif // ENCRYPTEDSETTINGS_H
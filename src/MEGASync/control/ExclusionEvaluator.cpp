@@ -0,0 +1,279 @@
+#include "ExclusionEvaluator.h"
+#include "Preferences.h"
+#include <QtCore>
+#include <math.h>
+
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrent>
+#endif
+
+using namespace mega;
+
+ExclusionRules::ExclusionRules()
+{
+    lowerSizeLimit = 0;
+    upperSizeLimit = 0;
+}
+
+ExclusionRules ExclusionRules::fromPreferences(Preferences *preferences)
+{
+    ExclusionRules rules;
+    rules.setNames(preferences->getExcludedSyncNames());
+    if (preferences->lowerSizeLimit())
+    {
+        rules.lowerSizeLimit = preferences->lowerSizeLimitValue() * pow((float)1024, preferences->lowerSizeLimitUnit());
+    }
+
+    if (preferences->upperSizeLimit())
+    {
+        rules.upperSizeLimit = preferences->upperSizeLimitValue() * pow((float)1024, preferences->upperSizeLimitUnit());
+    }
+    return rules;
+}
+
+void ExclusionRules::setNames(const QStringList &names)
+{
+    this->names = names;
+    if (names.isEmpty())
+    {
+        namePattern = QRegExp();
+        return;
+    }
+
+    QStringList expressions;
+    for (int i = 0; i < names.size(); i++)
+    {
+        expressions.append(wildcardToRegExp(names[i]));
+    }
+    namePattern = QRegExp(QString::fromUtf8("(?:%1)").arg(expressions.join(QString::fromAscii("|"))),
+                          Qt::CaseInsensitive, QRegExp::RegExp2);
+}
+
+QStringList ExclusionRules::getNames() const
+{
+    return names;
+}
+
+bool ExclusionRules::isNameExcluded(const QString &name) const
+{
+    if (names.isEmpty())
+    {
+        return false;
+    }
+
+    //QRegExp keeps the state of the last match, so each call uses its own copy.
+    //Copies share the compiled expression
+    QRegExp pattern(namePattern);
+    return pattern.exactMatch(name);
+}
+
+bool ExclusionRules::isSizeExcluded(long long size) const
+{
+    return (lowerSizeLimit && size < lowerSizeLimit)
+            || (upperSizeLimit && size > upperSizeLimit);
+}
+
+bool ExclusionRules::isExcluded(const QString &name, bool isFolder, long long size) const
+{
+    return isNameExcluded(name) || (!isFolder && isSizeExcluded(size));
+}
+
+//Same syntax as QRegExp::Wildcard: "*", "?" and sets of characters between brackets
+QString ExclusionRules::wildcardToRegExp(const QString &wildcard)
+{
+    QString expression;
+    for (int i = 0; i < wildcard.size(); i++)
+    {
+        QChar c = wildcard[i];
+        if (c == QChar::fromAscii('*'))
+        {
+            expression.append(QString::fromAscii(".*"));
+        }
+        else if (c == QChar::fromAscii('?'))
+        {
+            expression.append(QChar::fromAscii('.'));
+        }
+        else if (c == QChar::fromAscii('[') && wildcard.indexOf(QChar::fromAscii(']'), i + 2) > 0)
+        {
+            int end = wildcard.indexOf(QChar::fromAscii(']'), i + 2);
+            expression.append(wildcard.mid(i, end - i + 1));
+            i = end;
+        }
+        else
+        {
+            expression.append(QRegExp::escape(QString(c)));
+        }
+    }
+    return expression;
+}
+
+ExclusionEvaluation::ExclusionEvaluation()
+{
+    numVisited = 0;
+    elapsedMs = 0;
+}
+
+ExclusionEvaluator::ExclusionEvaluator(QObject *parent) : QObject(parent)
+{
+    connect(&watcher, SIGNAL(finished()), this, SLOT(onEvaluationFinished()));
+}
+
+ExclusionEvaluator::~ExclusionEvaluator()
+{
+    watcher.waitForFinished();
+}
+
+void ExclusionEvaluator::evaluate(const ExclusionRules &oldRules, const ExclusionRules &newRules, const QList<ExclusionSync> &syncs)
+{
+    PendingEvaluation evaluation;
+    evaluation.oldRules = oldRules;
+    evaluation.newRules = newRules;
+    evaluation.syncs = syncs;
+    pendingEvaluations.enqueue(evaluation);
+
+    if (!watcher.isRunning())
+    {
+        startNextEvaluation();
+    }
+}
+
+void ExclusionEvaluator::onEvaluationFinished()
+{
+    emit evaluationFinished(watcher.result());
+    startNextEvaluation();
+}
+
+void ExclusionEvaluator::startNextEvaluation()
+{
+    //Evaluations run in order, so each one starts from the result of the previous one
+    if (pendingEvaluations.isEmpty())
+    {
+        return;
+    }
+
+    PendingEvaluation evaluation = pendingEvaluations.dequeue();
+    watcher.setFuture(QtConcurrent::run(ExclusionEvaluator::evaluateSyncs, evaluation.oldRules,
+                                        evaluation.newRules, evaluation.syncs));
+}
+
+ExclusionEvaluation ExclusionEvaluator::evaluateSyncs(ExclusionRules oldRules, ExclusionRules newRules, QList<ExclusionSync> syncs)
+{
+    ExclusionEvaluation evaluation;
+    QElapsedTimer timer;
+    timer.start();
+
+    //Only the relaxed rules can make an excluded entry syncable
+    QStringList oldNames = oldRules.getNames();
+    QStringList newNames = newRules.getNames();
+    QStringList relaxedNames;
+    for (int i = 0; i < oldNames.size(); i++)
+    {
+        if (!newNames.contains(oldNames[i]))
+        {
+            relaxedNames.append(oldNames[i]);
+        }
+    }
+
+    ExclusionRules relaxedRules;
+    relaxedRules.setNames(relaxedNames);
+    if (oldRules.lowerSizeLimit && (!newRules.lowerSizeLimit || newRules.lowerSizeLimit < oldRules.lowerSizeLimit))
+    {
+        relaxedRules.lowerSizeLimit = oldRules.lowerSizeLimit;
+    }
+    if (oldRules.upperSizeLimit && (!newRules.upperSizeLimit || newRules.upperSizeLimit > oldRules.upperSizeLimit))
+    {
+        relaxedRules.upperSizeLimit = oldRules.upperSizeLimit;
+    }
+
+    if (relaxedNames.isEmpty() && !relaxedRules.lowerSizeLimit && !relaxedRules.upperSizeLimit)
+    {
+        evaluation.elapsedMs = timer.elapsed();
+        return evaluation;
+    }
+
+    for (int i = 0; i < syncs.size(); i++)
+    {
+        ExclusionVisitor visitor(oldRules, newRules, relaxedRules, syncs[i]);
+        FileSystemWalker walker(FileSystemWalker::WALK_SIZES, &visitor);
+        walker.walk(syncs[i].localFolder);
+        evaluation.numVisited += walker.getNumFiles() + walker.getNumFolders();
+        evaluation.newlyIncluded.append(visitor.newlyIncluded);
+    }
+
+    evaluation.elapsedMs = timer.elapsed();
+    return evaluation;
+}
+
+ExclusionEvaluator::ExclusionVisitor::ExclusionVisitor(const ExclusionRules &oldRules, const ExclusionRules &newRules,
+                                                       const ExclusionRules &relaxedRules, const ExclusionSync &sync)
+    : oldRules(oldRules), newRules(newRules), relaxedRules(relaxedRules)
+{
+    this->sync = sync;
+}
+
+void ExclusionEvaluator::ExclusionVisitor::visit(const QString &path, const QString &relativePath, bool isFolder, long long size)
+{
+    //Folders are visited before their contents,
+    //so the state of the parent is always known
+    int separatorIndex = relativePath.lastIndexOf(QDir::separator());
+    QString parent = separatorIndex < 0 ? QString() : relativePath.left(separatorIndex);
+    QString name = relativePath.mid(separatorIndex + 1);
+
+    bool skipped = false;
+    bool included = false;
+    if (!parent.isEmpty())
+    {
+        QMutexLocker locker(&mutex);
+        skipped = skippedFolders.contains(parent);
+        included = !skipped && includedFolders.contains(parent);
+    }
+
+    if (skipped || (parent.isEmpty() && name == QString::fromAscii(MEGA_DEBRIS_FOLDER)))
+    {
+        skipped = true;
+    }
+    else if (included)
+    {
+        //The contents of a folder that isn't excluded anymore are new for the
+        //engine too, except the entries excluded by the current rules
+        skipped = newRules.isExcluded(name, isFolder, size);
+    }
+    else
+    {
+        //Cheap test against the relaxed rules first
+        included = relaxedRules.isExcluded(name, isFolder, size)
+                && oldRules.isExcluded(name, isFolder, size)
+                && !newRules.isExcluded(name, isFolder, size);
+
+        //The contents of excluded folders are never synced
+        skipped = !included && isFolder && newRules.isNameExcluded(name);
+    }
+
+    QMutexLocker locker(&mutex);
+    if (skipped)
+    {
+        if (isFolder)
+        {
+            skippedFolders.insert(relativePath);
+        }
+        return;
+    }
+
+    if (!included)
+    {
+        return;
+    }
+
+    if (isFolder)
+    {
+        includedFolders.insert(relativePath);
+    }
+
+    ExclusionChange change;
+    change.syncId = sync.syncId;
+    change.megaFolderHandle = sync.megaFolderHandle;
+    change.localPath = QDir::toNativeSeparators(path);
+    change.relativePath = QDir::fromNativeSeparators(relativePath);
+    change.isFolder = isFolder;
+    newlyIncluded.append(change);
+}
@@ -0,0 +1,137 @@
+#ifndef EXCLUSIONEVALUATOR_H
+#define EXCLUSIONEVALUATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QQueue>
+#include <QSet>
+#include <QMutex>
+#include <QRegExp>
+#include <QFutureWatcher>
+#include <megaapi.h>
+#include "FileSystemWalker.h"
+
+class Preferences;
+
+//Excluded names (wildcards) and size limits in bytes (0 = no limit).
+//The wildcards are compiled into a single expression when they are set
+class ExclusionRules
+{
+public:
+    ExclusionRules();
+    static ExclusionRules fromPreferences(Preferences *preferences);
+
+    void setNames(const QStringList &names);
+    QStringList getNames() const;
+
+    //Can be called from several threads at the same time
+    bool isNameExcluded(const QString &name) const;
+    bool isSizeExcluded(long long size) const;
+    bool isExcluded(const QString &name, bool isFolder, long long size) const;
+
+    long long lowerSizeLimit;
+    long long upperSizeLimit;
+
+protected:
+    static QString wildcardToRegExp(const QString &wildcard);
+
+    QStringList names;
+    QRegExp namePattern;
+};
+
+class ExclusionSync
+{
+public:
+    int syncId;
+    QString localFolder;
+    mega::MegaHandle megaFolderHandle;
+};
+
+//Local entry that was excluded by the previous rules and isn't excluded anymore
+class ExclusionChange
+{
+public:
+    int syncId;
+    mega::MegaHandle megaFolderHandle;
+    QString localPath;
+    //Path relative to the root of the sync, with '/' separators
+    QString relativePath;
+    bool isFolder;
+};
+
+class ExclusionEvaluation
+{
+public:
+    ExclusionEvaluation();
+
+    //Parents are always before their contents
+    QList<ExclusionChange> newlyIncluded;
+    long long numVisited;
+    long long elapsedMs;
+};
+
+//Applies a change of the exclusion rules to the existing syncs without a restart.
+//Only the rules that changed are evaluated: if no rule was relaxed, no entry can
+//become syncable and nothing is scanned. Otherwise the local folders are walked
+//by a FileSystemWalker in the global thread pool, testing each entry against the
+//relaxed rules first. The contents of the folders that aren't excluded anymore are
+//reported too, except the entries that the new rules still exclude.
+//Tightened rules aren't evaluated: the sync engine applies them to the next changes
+//of the affected entries, synced copies are kept in the cloud
+class ExclusionEvaluator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ExclusionEvaluator(QObject *parent = 0);
+    virtual ~ExclusionEvaluator();
+
+    void evaluate(const ExclusionRules &oldRules, const ExclusionRules &newRules, const QList<ExclusionSync> &syncs);
+
+signals:
+    void evaluationFinished(const ExclusionEvaluation &evaluation);
+
+protected slots:
+    void onEvaluationFinished();
+
+protected:
+    class PendingEvaluation
+    {
+    public:
+        ExclusionRules oldRules;
+        ExclusionRules newRules;
+        QList<ExclusionSync> syncs;
+    };
+
+    class ExclusionVisitor : public FileSystemVisitor
+    {
+    public:
+        ExclusionVisitor(const ExclusionRules &oldRules, const ExclusionRules &newRules,
+                         const ExclusionRules &relaxedRules, const ExclusionSync &sync);
+
+        void visit(const QString &path, const QString &relativePath, bool isFolder, long long size);
+
+        const ExclusionRules &oldRules;
+        const ExclusionRules &newRules;
+        //Names excluded before and not now, and limits only if they were relaxed
+        const ExclusionRules &relaxedRules;
+        ExclusionSync sync;
+
+        QMutex mutex;
+        //Folders whose contents are ignored (excluded, or the debris folder)
+        QSet<QString> skippedFolders;
+        //Folders that aren't excluded anymore, their contents are included too
+        QSet<QString> includedFolders;
+        QList<ExclusionChange> newlyIncluded;
+    };
+
+    void startNextEvaluation();
+    static ExclusionEvaluation evaluateSyncs(ExclusionRules oldRules, ExclusionRules newRules, QList<ExclusionSync> syncs);
+
+    QFutureWatcher<ExclusionEvaluation> watcher;
+    QQueue<PendingEvaluation> pendingEvaluations;
+};
+
+#endif // EXCLUSIONEVALUATOR_H
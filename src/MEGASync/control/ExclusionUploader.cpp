@@ -0,0 +1,152 @@
+#include "ExclusionUploader.h"
+#include <QDir>
+
+using namespace mega;
+
+ExclusionUploader::ExclusionUploader(MegaApi *megaApi, QObject *parent) : QObject(parent)
+{
+    this->megaApi = megaApi;
+    delegateListener = new QTMegaRequestListener(megaApi, this);
+}
+
+ExclusionUploader::~ExclusionUploader()
+{
+    delete delegateListener;
+}
+
+void ExclusionUploader::upload(const QList<ExclusionChange> &changes)
+{
+    for (int i = 0; i < changes.size(); i++)
+    {
+        const ExclusionChange &change = changes[i];
+
+        //The remote folder of the parent doesn't exist yet
+        QString parentPath = getParentPath(change.localPath);
+        QHash<QString, QList<ExclusionChange> >::iterator it = pendingEntries.find(parentPath);
+        if (it != pendingEntries.end())
+        {
+            it->append(change);
+            if (change.isFolder)
+            {
+                pendingEntries.insert(change.localPath, QList<ExclusionChange>());
+            }
+            continue;
+        }
+
+        MegaNode *root = megaApi->getNodeByHandle(change.megaFolderHandle);
+        if (!root)
+        {
+            continue;
+        }
+
+        int separatorIndex = change.relativePath.lastIndexOf(QChar::fromAscii('/'));
+        MegaNode *parent = root;
+        if (separatorIndex > 0)
+        {
+            parent = megaApi->getNodeByPath(change.relativePath.left(separatorIndex).toUtf8().constData(), root);
+            delete root;
+        }
+
+        if (!parent)
+        {
+            MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Remote parent not found for %1")
+                         .arg(change.localPath).toUtf8().constData());
+            continue;
+        }
+
+        upload(change, parent);
+        delete parent;
+    }
+}
+
+void ExclusionUploader::onRequestFinish(MegaApi *, MegaRequest *request, MegaError *e)
+{
+    if (request->getType() != MegaRequest::TYPE_CREATE_FOLDER || creatingFolders.isEmpty())
+    {
+        return;
+    }
+
+    QString localFolder = creatingFolders.dequeue();
+    MegaNode *parent = megaApi->getNodeByHandle(request->getNodeHandle());
+    if (e->getErrorCode() != MegaError::API_OK || !parent)
+    {
+        MegaApi::log(MegaApi::LOG_LEVEL_ERROR, QString::fromUtf8("Unable to create the folder %1: %2")
+                     .arg(localFolder).arg(QString::fromUtf8(e->getErrorString())).toUtf8().constData());
+        discard(localFolder);
+        delete parent;
+        return;
+    }
+
+    QList<ExclusionChange> contents = pendingEntries.take(localFolder);
+    for (int i = 0; i < contents.size(); i++)
+    {
+        upload(contents[i], parent);
+    }
+    delete parent;
+}
+
+void ExclusionUploader::upload(const ExclusionChange &change, MegaNode *parent)
+{
+    QString name = change.relativePath.mid(change.relativePath.lastIndexOf(QChar::fromAscii('/')) + 1);
+    MegaNode *existing = getChild(parent, name, change.isFolder ? MegaNode::TYPE_FOLDER : MegaNode::TYPE_FILE);
+    if (existing)
+    {
+        //Contents waiting for this folder go to the existing one
+        QList<ExclusionChange> contents = pendingEntries.take(change.localPath);
+        for (int i = 0; i < contents.size(); i++)
+        {
+            upload(contents[i], existing);
+        }
+        delete existing;
+        return;
+    }
+
+    if (change.isFolder)
+    {
+        creatingFolders.enqueue(change.localPath);
+        if (!pendingEntries.contains(change.localPath))
+        {
+            pendingEntries.insert(change.localPath, QList<ExclusionChange>());
+        }
+        megaApi->createFolder(name.toUtf8().constData(), parent, delegateListener);
+    }
+    else
+    {
+        megaApi->startUpload(change.localPath.toUtf8().constData(), parent);
+    }
+}
+
+void ExclusionUploader::discard(const QString &localFolder)
+{
+    QList<ExclusionChange> contents = pendingEntries.take(localFolder);
+    for (int i = 0; i < contents.size(); i++)
+    {
+        if (contents[i].isFolder)
+        {
+            discard(contents[i].localPath);
+        }
+    }
+}
+
+MegaNode *ExclusionUploader::getChild(MegaNode *parent, const QString &name, int type)
+{
+    MegaNodeList *children = megaApi->getChildren(parent);
+    QByteArray utf8name = name.toUtf8();
+    MegaNode *child = NULL;
+    for (int i = 0; i < children->size(); i++)
+    {
+        MegaNode *node = children->get(i);
+        if (node->getType() == type && !strcmp(utf8name.constData(), node->getName()))
+        {
+            child = node->copy();
+            break;
+        }
+    }
+    delete children;
+    return child;
+}
+
+QString ExclusionUploader::getParentPath(const QString &localPath)
+{
+    return localPath.left(localPath.lastIndexOf(QDir::separator()));
+}
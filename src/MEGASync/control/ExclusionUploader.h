@@ -0,0 +1,47 @@
+#ifndef EXCLUSIONUPLOADER_H
+#define EXCLUSIONUPLOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QQueue>
+#include <megaapi.h>
+#include "QTMegaRequestListener.h"
+#include "ExclusionEvaluator.h"
+
+//Creates in the cloud the local entries that aren't excluded anymore.
+//The sync engine doesn't scan the synced folders again when the exclusions
+//change, so each entry is uploaded to the same relative path inside the remote
+//folder of its sync and the engine matches both when it sees them.
+//Local files are never moved nor copied. Entries that already exist in the cloud
+//are left to the engine. The contents of new folders are uploaded when the
+//remote folder has been created
+class ExclusionUploader : public QObject, public mega::MegaRequestListener
+{
+    Q_OBJECT
+
+public:
+    explicit ExclusionUploader(mega::MegaApi *megaApi, QObject *parent = 0);
+    virtual ~ExclusionUploader();
+
+    //Parents must be before their contents
+    void upload(const QList<ExclusionChange> &changes);
+
+    virtual void onRequestFinish(mega::MegaApi *api, mega::MegaRequest *request, mega::MegaError *e);
+
+protected:
+    void upload(const ExclusionChange &change, mega::MegaNode *parent);
+    void discard(const QString &localFolder);
+    mega::MegaNode *getChild(mega::MegaNode *parent, const QString &name, int type);
+    static QString getParentPath(const QString &localPath);
+
+    mega::MegaApi *megaApi;
+    mega::QTMegaRequestListener *delegateListener;
+    //Local paths of the folders being created, in the order of the requests
+    QQueue<QString> creatingFolders;
+    //Entries waiting for the creation of their remote parent, by local path of the parent
+    QHash<QString, QList<ExclusionChange> > pendingEntries;
+};
+
+#endif // EXCLUSIONUPLOADER_H
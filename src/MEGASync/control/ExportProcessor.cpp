@@ -1,76 +1,192 @@
 #include "ExportProcessor.h"
+#include "Preferences.h"
+#include <QtCore>
+
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrent>
+#endif
 
 using namespace mega;
 using namespace std;
 
-ExportProcessor::ExportProcessor(MegaApi *megaApi, QStringList fileList) : QObject()
+//Resolves a local path to the handle of its node (synced node or fingerprint match).
+//Runs in the global thread pool, so several fingerprints are computed at the same time
+class ExportNodeResolver
+{
+public:
+    typedef MegaHandle result_type;
+
+    ExportNodeResolver(MegaApi *megaApi) : megaApi(megaApi) {}
+
+    MegaHandle operator()(const QString &path)
+    {
+#ifdef WIN32
+        string tmpPath((const char*)path.utf16(), path.size()*sizeof(wchar_t));
+#else
+        string tmpPath((const char*)path.toUtf8().constData());
+#endif
+
+        MegaNode *node = megaApi->getSyncedNode(&tmpPath);
+        if (!node)
+        {
+            const char *fpLocal = megaApi->getFingerprint(tmpPath.c_str());
+            if (fpLocal)
+            {
+                node = megaApi->getNodeByFingerprint(fpLocal);
+                delete [] fpLocal;
+            }
+        }
+
+        if (!node)
+        {
+            return INVALID_HANDLE;
+        }
+
+        MegaHandle handle = node->getHandle();
+        delete node;
+        return handle;
+    }
+
+protected:
+    MegaApi *megaApi;
+};
+
+ExportProcessor::ExportProcessor(MegaApi *megaApi, QStringList fileList, int maxRequestsInFlight) : QObject()
 {
     this->megaApi = megaApi;
     this->fileList = fileList;
+    this->maxRequestsInFlight = (maxRequestsInFlight > 0) ? maxRequestsInFlight
+                                                          : Preferences::MAX_EXPORT_REQUESTS_IN_FLIGHT;
 
-    currentIndex = 0;
+    requestsInFlight = 0;
     remainingNodes = fileList.size();
     importSuccess = 0;
     importFailed = 0;
+    for (int i = 0; i < fileList.size(); i++)
+    {
+        publicLinks.append(QString());
+    }
 
     delegateListener = new QTMegaRequestListener(megaApi, this);
+    connect(&resolveWatcher, SIGNAL(resultReadyAt(int)), this, SLOT(onNodeResolved(int)));
 }
 
 ExportProcessor::~ExportProcessor()
 {
+    resolveWatcher.cancel();
+    resolveWatcher.waitForFinished();
     delete delegateListener;
 }
 
 void ExportProcessor::requestLinks()
 {
-    for (int i = 0; i < fileList.size(); i++)
+    if (!remainingNodes)
     {
+        emit onRequestLinksFinished();
+        return;
+    }
+
 #ifdef WIN32
+    for (int i = 0; i < fileList.size(); i++)
+    {
         if (!fileList[i].startsWith(QString::fromAscii("\\\\")))
         {
             fileList[i].insert(0, QString::fromAscii("\\\\?\\"));
         }
-
-        string tmpPath((const char*)fileList[i].utf16(), fileList[i].size()*sizeof(wchar_t));
-#else
-        string tmpPath((const char*)fileList[i].toUtf8().constData());
+    }
 #endif
 
-        MegaNode *node = megaApi->getSyncedNode(&tmpPath);
+    resolveWatcher.setFuture(QtConcurrent::mapped(fileList, ExportNodeResolver(megaApi)));
+}
+
+QStringList ExportProcessor::getValidLinks()
+{
+    return validPublicLinks;
+}
+
+void ExportProcessor::onNodeResolved(int index)
+{
+    if (resolveWatcher.resultAt(index) == INVALID_HANDLE)
+    {
+        MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Unable to find the node to export: %1")
+                     .arg(fileList[index]).toUtf8().constData());
+        importFailed++;
+        linkFinished(index, QString());
+        return;
+    }
+
+    pendingExports.enqueue(index);
+    processPendingExports();
+}
+
+void ExportProcessor::processPendingExports()
+{
+    while (requestsInFlight < maxRequestsInFlight && !pendingExports.isEmpty())
+    {
+        int index = pendingExports.dequeue();
+        MegaHandle handle = resolveWatcher.resultAt(index);
+        MegaNode *node = megaApi->getNodeByHandle(handle);
         if (!node)
         {
-            const char *fpLocal = megaApi->getFingerprint(tmpPath.c_str());
-            node = megaApi->getNodeByFingerprint(fpLocal);
-            delete [] fpLocal;
+            importFailed++;
+            linkFinished(index, QString());
+            continue;
         }
+
+        requestIndexes.insert(handle, index);
+        requestsInFlight++;
         megaApi->exportNode(node, delegateListener);
         delete node;
     }
 }
 
-QStringList ExportProcessor::getValidLinks()
+void ExportProcessor::linkFinished(int index, QString link)
 {
-    return validPublicLinks;
+    publicLinks[index] = link;
+    remainingNodes--;
+    if (remainingNodes)
+    {
+        return;
+    }
+
+    for (int i = 0; i < publicLinks.size(); i++)
+    {
+        if (!publicLinks[i].isEmpty())
+        {
+            validPublicLinks.append(publicLinks[i]);
+        }
+    }
+    emit onRequestLinksFinished();
 }
 
 void ExportProcessor::onRequestFinish(MegaApi *, MegaRequest *request, MegaError *e)
 {
-    currentIndex++;
-    remainingNodes--;
+    if (request->getType() != MegaRequest::TYPE_EXPORT)
+    {
+        return;
+    }
+
+    //Several files can resolve to the same node, any pending index for it gets the link
+    QMultiHash<MegaHandle, int>::iterator it = requestIndexes.find(request->getNodeHandle());
+    if (it == requestIndexes.end())
+    {
+        return;
+    }
+    int index = it.value();
+    requestIndexes.erase(it);
+    requestsInFlight--;
+
+    QString link;
     if (e->getErrorCode() != MegaError::API_OK)
     {
-        publicLinks.append(QString());
         importFailed++;
     }
     else
     {
-        publicLinks.append(QString::fromAscii(request->getLink()));
-        validPublicLinks.append(QString::fromAscii(request->getLink()));
+        link = QString::fromAscii(request->getLink());
         importSuccess++;
     }
 
-    if (!remainingNodes)
-    {
-        emit onRequestLinksFinished();
-    }
+    processPendingExports();
+    linkFinished(index, link);
 }
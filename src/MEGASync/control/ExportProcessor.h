@@ -2,6 +2,9 @@
 #define EXPORTPROCESSOR_H
 
 #include <QStringList>
+#include <QFutureWatcher>
+#include <QMultiHash>
+#include <QQueue>
 #include <megaapi.h>
 #include <QTMegaRequestListener.h>
 
@@ -9,10 +12,11 @@ class ExportProcessor :  public QObject, public mega::MegaRequestListener
 {
     Q_OBJECT
 public:
-    explicit ExportProcessor(mega::MegaApi *megaApi, QStringList fileList);
+    explicit ExportProcessor(mega::MegaApi *megaApi, QStringList fileList, int maxRequestsInFlight = 0);
     virtual ~ExportProcessor();
 
     void requestLinks();
+    //Valid links, in the same order as the input file list
     QStringList getValidLinks();
 
 signals:
@@ -21,12 +25,22 @@ signals:
 public slots:
     virtual void onRequestFinish(mega::MegaApi* api, mega::MegaRequest *request, mega::MegaError* e);
 
+protected slots:
+    void onNodeResolved(int index);
+
 protected:
+    void processPendingExports();
+    void linkFinished(int index, QString link);
+
     mega::MegaApi *megaApi;
     QStringList fileList;
     QStringList publicLinks;
     QStringList validPublicLinks;
-    int currentIndex;
+    QFutureWatcher<mega::MegaHandle> resolveWatcher;
+    QQueue<int> pendingExports;
+    QMultiHash<mega::MegaHandle, int> requestIndexes;
+    int maxRequestsInFlight;
+    int requestsInFlight;
     int remainingNodes;
     int importSuccess;
     int importFailed;
@@ -0,0 +1,395 @@
+#include "FileCopier.h"
+#include "Preferences.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QtCore>
+
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrent>
+#endif
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#endif
+
+#ifdef __APPLE__
+#include <AvailabilityMacros.h>
+#if MAC_OS_X_VERSION_MAX_ALLOWED >= 101200
+#include <sys/clonefile.h>
+#define HAVE_CLONEFILE
+#endif
+#endif
+
+//Cancels the walk that calculates the size of the tree when the copier is cancelled
+class SizeWalkVisitor : public FileSystemVisitor
+{
+public:
+    explicit SizeWalkVisitor(QAtomicInt *cancelled) : walker(NULL), cancelled(cancelled) {}
+    void visit(const QString &, const QString &, bool, long long)
+    {
+        if (*cancelled)
+        {
+            walker->cancel();
+        }
+    }
+
+    FileSystemWalker *walker;
+
+protected:
+    QAtomicInt *cancelled;
+};
+
+FileCopier::FileCopier(QObject *parent) : QObject(parent)
+{
+    cancelled = 0;
+}
+
+FileCopier::~FileCopier()
+{
+    //Running copies use this object to report their progress.
+    //Walks and copies in progress are aborted
+    cancelled = 1;
+    for (int i = 0; i < copies.size(); i++)
+    {
+        copies[i].waitForFinished();
+    }
+}
+
+void FileCopier::copy(QString srcPath, QString dstPath, bool allowHardLinks)
+{
+    for (int i = copies.size() - 1; i >= 0; i--)
+    {
+        if (copies[i].isFinished())
+        {
+            copies.removeAt(i);
+        }
+    }
+
+    copies.append(QtConcurrent::run(FileCopier::copyTree, srcPath, dstPath, allowHardLinks, this));
+}
+
+int FileCopier::copyFile(QString srcPath, QString dstPath, bool allowHardLinks)
+{
+    long long reportedBytes;
+    return copyFile(srcPath, dstPath, allowHardLinks, NULL, &reportedBytes);
+}
+
+#ifdef __linux__
+int FileCopier::copyFile(QString srcPath, QString dstPath, bool allowHardLinks,
+                         CopyVisitor *visitor, long long *reportedBytes)
+{
+    *reportedBytes = 0;
+    QByteArray src = QFile::encodeName(srcPath);
+    QByteArray dst = QFile::encodeName(dstPath);
+    int srcFd = open(src.constData(), O_RDONLY);
+    if (srcFd < 0)
+    {
+        return COPY_FAILED;
+    }
+
+    struct stat info;
+    if (fstat(srcFd, &info) || !S_ISREG(info.st_mode))
+    {
+        close(srcFd);
+        return COPY_FAILED;
+    }
+
+    int dstFd = open(dst.constData(), O_WRONLY | O_CREAT | O_EXCL, info.st_mode & 0777);
+    if (dstFd < 0)
+    {
+        close(srcFd);
+        return COPY_FAILED;
+    }
+
+    int method = COPY_FAILED;
+
+#ifdef FICLONE
+    //Copy on write filesystems (btrfs, XFS) share the extents of both files
+    if (!ioctl(dstFd, FICLONE, srcFd))
+    {
+        method = COPY_REFLINK;
+    }
+#endif
+
+    if (method == COPY_FAILED && allowHardLinks)
+    {
+        close(dstFd);
+        unlink(dst.constData());
+        if (!link(src.constData(), dst.constData()))
+        {
+            close(srcFd);
+            return COPY_HARDLINK;
+        }
+
+        dstFd = open(dst.constData(), O_WRONLY | O_CREAT | O_EXCL, info.st_mode & 0777);
+        if (dstFd < 0)
+        {
+            close(srcFd);
+            return COPY_FAILED;
+        }
+    }
+
+    long long remaining = info.st_size;
+    bool aborted = false;
+
+#ifdef __NR_copy_file_range
+    //The data doesn't go through user space. If the kernel or the filesystem
+    //doesn't support it, the regular copy continues from the current offsets.
+    //Chunks are small enough to report the progress and to cancel big files
+    if (method == COPY_FAILED)
+    {
+        while (remaining > 0)
+        {
+            if (visitor && visitor->isCancelled())
+            {
+                aborted = true;
+                break;
+            }
+
+            long copied = syscall(__NR_copy_file_range, srcFd, NULL, dstFd, NULL,
+                                  (size_t)qMin(remaining, 64LL << 20), 0);
+            if (copied <= 0)
+            {
+                break;
+            }
+            remaining -= copied;
+            if (visitor)
+            {
+                visitor->addProgress(copied);
+                *reportedBytes += copied;
+            }
+        }
+
+        if (!remaining)
+        {
+            method = COPY_IN_KERNEL;
+        }
+    }
+#endif
+
+    if (method == COPY_FAILED && !aborted)
+    {
+        QByteArray buffer(1 << 20, 0);
+        bool failed = false;
+        ssize_t bytesRead;
+        while (!failed && (bytesRead = read(srcFd, buffer.data(), buffer.size())) > 0)
+        {
+            if (visitor && visitor->isCancelled())
+            {
+                failed = true;
+                break;
+            }
+
+            ssize_t written = 0;
+            while (written < bytesRead)
+            {
+                ssize_t result = write(dstFd, buffer.constData() + written, bytesRead - written);
+                if (result <= 0)
+                {
+                    failed = true;
+                    break;
+                }
+                written += result;
+            }
+
+            if (!failed && visitor)
+            {
+                visitor->addProgress(written);
+                *reportedBytes += written;
+            }
+        }
+
+        if (!failed && !bytesRead)
+        {
+            method = COPY_REGULAR;
+        }
+    }
+
+    close(srcFd);
+    if (close(dstFd) || method == COPY_FAILED)
+    {
+        unlink(dst.constData());
+        return COPY_FAILED;
+    }
+    return method;
+}
+#else
+int FileCopier::copyFile(QString srcPath, QString dstPath, bool allowHardLinks,
+                         CopyVisitor *visitor, long long *reportedBytes)
+{
+    //QFile::copy doesn't report its progress. Files are reported when they finish
+    Q_UNUSED(visitor);
+    *reportedBytes = 0;
+
+#ifdef HAVE_CLONEFILE
+    if (!clonefile(QFile::encodeName(srcPath).constData(), QFile::encodeName(dstPath).constData(), 0))
+    {
+        return COPY_REFLINK;
+    }
+#endif
+
+    if (allowHardLinks)
+    {
+#ifdef WIN32
+        if (CreateHardLinkW((LPCWSTR)dstPath.utf16(), (LPCWSTR)srcPath.utf16(), NULL))
+#else
+        if (!link(QFile::encodeName(srcPath).constData(), QFile::encodeName(dstPath).constData()))
+#endif
+        {
+            return COPY_HARDLINK;
+        }
+    }
+
+    //QFile::copy uses CopyFile on Windows, so the system can
+    //clone the file or copy it in the server for remote volumes
+    return QFile::copy(srcPath, dstPath) ? COPY_REGULAR : COPY_FAILED;
+}
+#endif
+
+void FileCopier::copyTree(QString srcPath, QString dstPath, bool allowHardLinks, FileCopier *copier)
+{
+    if (!srcPath.size() || !dstPath.size() || srcPath == dstPath)
+    {
+        return;
+    }
+
+    QFileInfo source(srcPath);
+    if (!source.exists() || QFile(dstPath).exists())
+    {
+        return;
+    }
+
+    long long totalBytes = 0;
+    if (source.isFile())
+    {
+        totalBytes = source.size();
+    }
+    else if (source.isDir() && copier)
+    {
+        SizeWalkVisitor sizeVisitor(&copier->cancelled);
+        FileSystemWalker sizeWalker(FileSystemWalker::WALK_SIZES, &sizeVisitor);
+        sizeVisitor.walker = &sizeWalker;
+        if (copier->cancelled || !sizeWalker.walk(srcPath))
+        {
+            emit copier->copyFinished(dstPath, 0, 0, 0, 0);
+            return;
+        }
+        totalBytes = sizeWalker.getTotalSize();
+    }
+
+    CopyVisitor visitor(dstPath, allowHardLinks, totalBytes, copier);
+    if (source.isFile())
+    {
+        long long reportedBytes;
+        int method = copyFile(srcPath, dstPath, allowHardLinks, &visitor, &reportedBytes);
+        visitor.addFile(method, totalBytes, reportedBytes);
+    }
+    else if (source.isDir())
+    {
+        QDir dstDir(dstPath);
+        dstDir.mkpath(QString::fromAscii("."));
+        FileSystemWalker walker(FileSystemWalker::WALK_SIZES, &visitor);
+        visitor.walker = &walker;
+        walker.walk(srcPath);
+    }
+
+    if (copier)
+    {
+        emit copier->copyFinished(dstPath, visitor.copiedBytes, visitor.clonedBytes,
+                                  visitor.numFiles, visitor.numErrors);
+    }
+}
+
+FileCopier::CopyVisitor::CopyVisitor(QString dstPath, bool allowHardLinks, long long totalBytes, FileCopier *copier)
+{
+    this->dstPath = dstPath;
+    this->allowHardLinks = allowHardLinks;
+    this->copier = copier;
+    this->walker = NULL;
+    this->totalBytes = totalBytes;
+    this->copiedBytes = 0;
+    this->clonedBytes = 0;
+    this->partialBytes = 0;
+    this->numFiles = 0;
+    this->numErrors = 0;
+    this->lastProgress = 0;
+}
+
+void FileCopier::CopyVisitor::visit(const QString &path, const QString &relativePath, bool isFolder, long long size)
+{
+    //No more folders are created nor read once the copy is cancelled
+    if (isCancelled())
+    {
+        if (walker)
+        {
+            walker->cancel();
+        }
+        return;
+    }
+
+    QString target = dstPath + QDir::separator() + relativePath;
+    if (isFolder)
+    {
+        QDir(target).mkpath(QString::fromAscii("."));
+        return;
+    }
+
+    long long reportedBytes;
+    int method = FileCopier::copyFile(path, target, allowHardLinks, this, &reportedBytes);
+    addFile(method, size, reportedBytes);
+}
+
+void FileCopier::CopyVisitor::addFile(int method, long long size, long long reportedBytes)
+{
+    QMutexLocker locker(&mutex);
+    partialBytes -= reportedBytes;
+    if (method == COPY_FAILED)
+    {
+        numErrors++;
+        return;
+    }
+
+    numFiles++;
+    copiedBytes += size;
+    if (method == COPY_REFLINK || method == COPY_HARDLINK)
+    {
+        clonedBytes += size;
+    }
+    emitProgress();
+}
+
+void FileCopier::CopyVisitor::addProgress(long long bytes)
+{
+    QMutexLocker locker(&mutex);
+    partialBytes += bytes;
+    emitProgress();
+}
+
+bool FileCopier::CopyVisitor::isCancelled()
+{
+    return copier && copier->cancelled;
+}
+
+//Called with the mutex locked
+void FileCopier::CopyVisitor::emitProgress()
+{
+    long long now = QDateTime::currentMSecsSinceEpoch();
+    if (copier && (now - lastProgress) >= Preferences::LOCAL_COPY_PROGRESS_INTERVAL_MS)
+    {
+        lastProgress = now;
+        emit copier->copyProgress(dstPath, copiedBytes + partialBytes, totalBytes);
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef FILECOPIER_H
+#define FILECOPIER_H
+
+#include <QObject>
+#include <QString>
+#include <QMutex>
+#include <QFuture>
+#include <QList>
+#include <QAtomicInt>
+#include "FileSystemWalker.h"
+
+//Copies files and folders into synced folders avoiding to duplicate the data when the
+//filesystem allows it. Each file is cloned (FICLONE on Linux, clonefile on OS X) or,
+//if the user allows it, hard linked. Otherwise it's copied in the kernel
+//(copy_file_range on Linux) or with a regular copy.
+//The files of different folders are copied in parallel by a FileSystemWalker
+class FileCopier : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum
+    {
+        COPY_FAILED = -1,
+        COPY_REFLINK = 0,
+        COPY_HARDLINK,
+        COPY_IN_KERNEL,
+        COPY_REGULAR
+    };
+
+    explicit FileCopier(QObject *parent = 0);
+    virtual ~FileCopier();
+
+    //Copies a file or a folder in the global thread pool
+    void copy(QString srcPath, QString dstPath, bool allowHardLinks);
+
+    //Returns the method used to copy the file. The destination must not exist
+    static int copyFile(QString srcPath, QString dstPath, bool allowHardLinks);
+    //Copies a file or a folder tree. Symbolic links are skipped.
+    //Nothing is copied if the destination exists. copier can be NULL
+    static void copyTree(QString srcPath, QString dstPath, bool allowHardLinks, FileCopier *copier = NULL);
+
+signals:
+    void copyProgress(QString dstPath, long long copiedBytes, long long totalBytes);
+    void copyFinished(QString dstPath, long long copiedBytes, long long clonedBytes, int numFiles, int numErrors);
+
+protected:
+    class CopyVisitor : public FileSystemVisitor
+    {
+    public:
+        CopyVisitor(QString dstPath, bool allowHardLinks, long long totalBytes, FileCopier *copier);
+
+        void visit(const QString &path, const QString &relativePath, bool isFolder, long long size);
+        //reportedBytes are the bytes of the file already notified with addProgress
+        void addFile(int method, long long size, long long reportedBytes);
+        //Bytes copied of a file that is still being copied
+        void addProgress(long long bytes);
+        bool isCancelled();
+
+        QString dstPath;
+        bool allowHardLinks;
+        FileCopier *copier;
+        FileSystemWalker *walker;
+
+        QMutex mutex;
+        long long totalBytes;
+        long long copiedBytes;
+        long long clonedBytes;
+        //Bytes of the files being copied
+        long long partialBytes;
+        int numFiles;
+        int numErrors;
+        long long lastProgress;
+
+    protected:
+        void emitProgress();
+    };
+
+    //The progress of the copy is reported to the visitor and the copy is aborted
+    //if it's cancelled. reportedBytes receives the bytes reported. visitor can be NULL
+    static int copyFile(QString srcPath, QString dstPath, bool allowHardLinks,
+                        CopyVisitor *visitor, long long *reportedBytes);
+
+    QList<QFuture<void> > copies;
+    QAtomicInt cancelled;
+};
+
+#endif // FILECOPIER_H
@@ -0,0 +1,427 @@
+#include "FileSystemWalker.h"
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+const int FileSystemWalker::MAX_THREADS         = 4;
+const int FileSystemWalker::MAX_OPEN_FOLDERS    = 256;
+
+class FileSystemWalkerTask : public QRunnable
+{
+public:
+    explicit FileSystemWalkerTask(FileSystemWalker *walker) : walker(walker) {}
+
+    void run()
+    {
+        walker->work();
+
+        walker->mutex.lock();
+        walker->runningTasks--;
+        walker->condition.wakeAll();
+        walker->mutex.unlock();
+    }
+
+protected:
+    FileSystemWalker *walker;
+};
+
+FileSystemWalker::FileSystemWalker(int flags, FileSystemVisitor *visitor)
+{
+    this->flags = flags;
+    this->visitor = visitor;
+    this->maxFiles = -1;
+    this->maxFolders = -1;
+    this->rootLength = 0;
+    this->activeWorkers = 0;
+    this->runningTasks = 0;
+    this->cancelled = 0;
+    this->openParentFolders = 0;
+}
+
+void FileSystemWalker::setLimits(long long maxFiles, long long maxFolders)
+{
+    this->maxFiles = maxFiles;
+    this->maxFolders = maxFolders;
+}
+
+bool FileSystemWalker::walk(QString path)
+{
+    path = QDir::toNativeSeparators(path);
+    if (path.size() > 1 && path.endsWith(QDir::separator()))
+    {
+        path.chop(1);
+    }
+
+#ifdef WIN32
+    NativeWalkerPath root = path;
+#else
+    NativeWalkerPath root = QFile::encodeName(path);
+#endif
+
+    mutex.lock();
+    cancelled = 0;
+    totals = FolderStats();
+    pendingFolders.clear();
+    walkedFolders.clear();
+    pendingFolders.push(PendingFolder(root));
+    rootLength = root.size() + 1;
+    activeWorkers = 0;
+    runningTasks = 0;
+    mutex.unlock();
+
+    //The calling thread is always a worker, so the walk progresses
+    //even if there aren't free threads in the global pool
+    int numHelpers = qMin(QThread::idealThreadCount(), MAX_THREADS) - 1;
+    for (int i = 0; i < numHelpers; i++)
+    {
+        FileSystemWalkerTask *task = new FileSystemWalkerTask(this);
+        mutex.lock();
+        runningTasks++;
+        mutex.unlock();
+
+        if (!QThreadPool::globalInstance()->tryStart(task))
+        {
+            delete task;
+            mutex.lock();
+            runningTasks--;
+            mutex.unlock();
+            break;
+        }
+    }
+
+    work();
+
+    mutex.lock();
+    while (runningTasks)
+    {
+        condition.wait(&mutex);
+    }
+    walkedFolders.clear();
+
+    //Folders not read because the walk was cancelled
+    while (!pendingFolders.isEmpty())
+    {
+        releaseParent(pendingFolders.pop().parent);
+    }
+    mutex.unlock();
+    return !cancelled;
+}
+
+void FileSystemWalker::cancel()
+{
+    cancelled = 1;
+    mutex.lock();
+    condition.wakeAll();
+    mutex.unlock();
+}
+
+bool FileSystemWalker::isCancelled()
+{
+    return cancelled;
+}
+
+long long FileSystemWalker::getNumFiles()
+{
+    QMutexLocker locker(&mutex);
+    return totals.numFiles;
+}
+
+long long FileSystemWalker::getNumFolders()
+{
+    QMutexLocker locker(&mutex);
+    return totals.numFolders;
+}
+
+long long FileSystemWalker::getTotalSize()
+{
+    QMutexLocker locker(&mutex);
+    return totals.totalSize;
+}
+
+void FileSystemWalker::work()
+{
+    mutex.lock();
+    forever
+    {
+        //The walk finishes when there aren't pending folders
+        //and no other worker can add more
+        while (pendingFolders.isEmpty() && activeWorkers && !cancelled)
+        {
+            condition.wait(&mutex);
+        }
+
+        if (pendingFolders.isEmpty() || cancelled)
+        {
+            condition.wakeAll();
+            break;
+        }
+
+        PendingFolder folder = pendingFolders.pop();
+        activeWorkers++;
+        mutex.unlock();
+
+        QList<PendingFolder> subfolders;
+        FolderStats stats;
+        readFolder(folder, &subfolders, &stats);
+
+        mutex.lock();
+        activeWorkers--;
+        totals.numFiles += stats.numFiles;
+        totals.numFolders += stats.numFolders;
+        totals.totalSize += stats.totalSize;
+        for (int i = 0; i < subfolders.size(); i++)
+        {
+            pendingFolders.push(subfolders[i]);
+        }
+
+        if ((maxFiles >= 0 && totals.numFiles > maxFiles)
+                || (maxFolders >= 0 && totals.numFolders > maxFolders))
+        {
+            cancelled = 1;
+        }
+        condition.wakeAll();
+    }
+    mutex.unlock();
+}
+
+void FileSystemWalker::visit(const NativeWalkerPath &path, bool isFolder, long long size)
+{
+    if (!visitor)
+    {
+        return;
+    }
+
+#ifdef WIN32
+    visitor->visit(path, path.mid(rootLength), isFolder, size);
+#else
+    visitor->visit(QFile::decodeName(path), QFile::decodeName(path.mid(rootLength)), isFolder, size);
+#endif
+}
+
+void FileSystemWalker::releaseParent(ParentFolder *parent)
+{
+#ifndef WIN32
+    if (parent && !parent->references.deref())
+    {
+        close(parent->fd);
+        delete parent;
+        openParentFolders.deref();
+    }
+#else
+    Q_UNUSED(parent);
+#endif
+}
+
+#ifdef WIN32
+void FileSystemWalker::readFolder(const PendingFolder &folder, QList<PendingFolder> *subfolders, FolderStats *stats)
+{
+    const QString &path = folder.path;
+    //FindFirstFileEx returns the attributes and the size of the entries
+    //so there is no need to query them one by one
+    WIN32_FIND_DATAW data;
+    QString pattern = path + QString::fromAscii("\\*");
+#ifdef FIND_FIRST_EX_LARGE_FETCH
+    HANDLE handle = FindFirstFileExW((LPCWSTR)pattern.utf16(), FindExInfoBasic, &data,
+                                     FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+#else
+    HANDLE handle = FindFirstFileExW((LPCWSTR)pattern.utf16(), FindExInfoStandard, &data,
+                                     FindExSearchNameMatch, NULL, 0);
+#endif
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    do
+    {
+        QString name = QString::fromWCharArray(data.cFileName);
+        if (name == QString::fromAscii(".") || name == QString::fromAscii(".."))
+        {
+            continue;
+        }
+
+        bool isLink = (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+        if (isLink && !(flags & WALK_FOLLOW_SYMLINKS))
+        {
+            continue;
+        }
+
+        QString childPath = path + QString::fromAscii("\\") + name;
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            stats->numFolders++;
+            visit(childPath, true, (flags & WALK_SIZES) ? 0 : -1);
+
+            //Junctions can point to their parents and there is no cheap
+            //way to identify folders here, so they are never walked
+            if (!isLink)
+            {
+                subfolders->append(PendingFolder(childPath));
+            }
+        }
+        else
+        {
+            long long size = (((long long)data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+            stats->numFiles++;
+            stats->totalSize += size;
+            visit(childPath, false, (flags & WALK_SIZES) ? size : -1);
+        }
+    } while (!cancelled && FindNextFileW(handle, &data));
+
+    FindClose(handle);
+}
+#else
+void FileSystemWalker::readFolder(const PendingFolder &folder, QList<PendingFolder> *subfolders, FolderStats *stats)
+{
+    //Opening the folder relative to its parent avoids resolving the full path again
+    const NativeWalkerPath &path = folder.path;
+    int fd = -1;
+    if (folder.parent)
+    {
+        fd = openat(folder.parent->fd, path.constData() + folder.nameOffset, O_RDONLY | O_DIRECTORY);
+        releaseParent(folder.parent);
+    }
+
+    if (fd < 0)
+    {
+        fd = open(path.constData(), O_RDONLY | O_DIRECTORY);
+        if (fd < 0)
+        {
+            return;
+        }
+    }
+
+    bool followLinks = (flags & WALK_FOLLOW_SYMLINKS) != 0;
+    if (followLinks)
+    {
+        struct stat info;
+        if (!fstat(fd, &info))
+        {
+            QPair<unsigned long long, unsigned long long> id(info.st_dev, info.st_ino);
+            mutex.lock();
+            bool walked = walkedFolders.contains(id);
+            walkedFolders.insert(id);
+            mutex.unlock();
+
+            if (walked)
+            {
+                close(fd);
+                return;
+            }
+        }
+    }
+
+    DIR *dir = fdopendir(fd);
+    if (!dir)
+    {
+        close(fd);
+        return;
+    }
+
+    struct dirent *entry;
+    while (!cancelled && (entry = readdir(dir)))
+    {
+        const char *name = entry->d_name;
+        if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+        {
+            continue;
+        }
+
+        //The type from readdir is enough to classify most entries.
+        //They are only stat'ed when it's unknown, to follow a link or to get the size of a file
+        int type = entry->d_type;
+        long long size = -1;
+        if (type == DT_UNKNOWN || (type == DT_LNK && followLinks)
+                || (type == DT_REG && (flags & WALK_SIZES)))
+        {
+            struct stat info;
+            if (fstatat(dirfd(dir), name, &info, AT_SYMLINK_NOFOLLOW))
+            {
+                continue;
+            }
+
+            if (S_ISLNK(info.st_mode) && (!followLinks || fstatat(dirfd(dir), name, &info, 0)))
+            {
+                continue;
+            }
+
+            if (S_ISDIR(info.st_mode))
+            {
+                type = DT_DIR;
+            }
+            else if (S_ISREG(info.st_mode))
+            {
+                type = DT_REG;
+                size = info.st_size;
+            }
+            else
+            {
+                continue;
+            }
+        }
+
+        if (type != DT_DIR && type != DT_REG)
+        {
+            continue;
+        }
+
+        NativeWalkerPath childPath = path;
+        childPath.append('/');
+        childPath.append(name);
+        if (type == DT_DIR)
+        {
+            stats->numFolders++;
+            visit(childPath, true, (flags & WALK_SIZES) ? 0 : -1);
+            subfolders->append(PendingFolder(childPath, NULL, path.size() + 1));
+        }
+        else
+        {
+            stats->numFiles++;
+            if (size > 0)
+            {
+                stats->totalSize += size;
+            }
+            visit(childPath, false, (flags & WALK_SIZES) ? size : -1);
+        }
+    }
+
+    //The descriptor is kept open for the subfolders, up to a limit.
+    //Beyond it, they are opened by their full path
+    if (!cancelled && subfolders->size())
+    {
+        int parentFd = -1;
+        if (openParentFolders.fetchAndAddRelaxed(1) < MAX_OPEN_FOLDERS)
+        {
+            parentFd = dup(dirfd(dir));
+        }
+
+        if (parentFd >= 0)
+        {
+            ParentFolder *parent = new ParentFolder(parentFd, subfolders->size());
+            for (int i = 0; i < subfolders->size(); i++)
+            {
+                (*subfolders)[i].parent = parent;
+            }
+        }
+        else
+        {
+            openParentFolders.deref();
+        }
+    }
+
+    //Closes fd too
+    closedir(dir);
+}
+#endif
@@ -0,0 +1,126 @@
+#ifndef FILESYSTEMWALKER_H
+#define FILESYSTEMWALKER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QStack>
+#include <QSet>
+#include <QPair>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+
+#ifdef WIN32
+typedef QString NativeWalkerPath;
+#else
+typedef QByteArray NativeWalkerPath;
+#endif
+
+//Receives the entries found by a FileSystemWalker.
+//It's called from several threads at the same time
+class FileSystemVisitor
+{
+public:
+    virtual ~FileSystemVisitor() {}
+
+    //Folders are visited before their contents.
+    //size is -1 unless the walker was created with WALK_SIZES
+    virtual void visit(const QString &path, const QString &relativePath, bool isFolder, long long size) = 0;
+};
+
+//Walks a local folder tree in parallel.
+//The folders pending to be read are shared by the calling thread and up to
+//MAX_THREADS - 1 helpers of the global thread pool.
+//On Windows entries are read with FindFirstFileEx. In the rest of platforms
+//folders are opened with openat, relative to the descriptor of their parent,
+//and read with readdir. Entries are only stat'ed (fstatat, relative to the folder)
+//when their type isn't known or their size is needed
+class FileSystemWalker
+{
+public:
+    enum
+    {
+        WALK_SIZES = 1,
+        //Follow symbolic links to files and folders. Otherwise they are skipped.
+        //Folders already walked are not walked again, so loops are safe
+        WALK_FOLLOW_SYMLINKS = 2
+    };
+
+    explicit FileSystemWalker(int flags = 0, FileSystemVisitor *visitor = NULL);
+
+    //Cancels the walk when the number of files or folders is higher than the limit (-1 = no limit)
+    void setLimits(long long maxFiles, long long maxFolders);
+    //Returns false if the walk has been cancelled
+    bool walk(QString path);
+    //Can be called from any thread
+    void cancel();
+    bool isCancelled();
+
+    //Totals don't include the root folder
+    long long getNumFiles();
+    long long getNumFolders();
+    long long getTotalSize();
+
+    static const int MAX_THREADS;
+    //Descriptors of folders kept open for their subfolders
+    static const int MAX_OPEN_FOLDERS;
+
+protected:
+    friend class FileSystemWalkerTask;
+
+    class FolderStats
+    {
+    public:
+        FolderStats() : numFiles(0), numFolders(0), totalSize(0) {}
+
+        long long numFiles;
+        long long numFolders;
+        long long totalSize;
+    };
+
+    //Open descriptor of a folder shared by its pending subfolders (POSIX only)
+    class ParentFolder
+    {
+    public:
+        ParentFolder(int fd, int references) : fd(fd), references(references) {}
+
+        int fd;
+        QAtomicInt references;
+    };
+
+    class PendingFolder
+    {
+    public:
+        PendingFolder() : parent(NULL), nameOffset(0) {}
+        PendingFolder(const NativeWalkerPath &path, ParentFolder *parent = NULL, int nameOffset = 0)
+            : path(path), parent(parent), nameOffset(nameOffset) {}
+
+        NativeWalkerPath path;
+        ParentFolder *parent;
+        //Position of the name of the folder in path
+        int nameOffset;
+    };
+
+    void work();
+    void readFolder(const PendingFolder &folder, QList<PendingFolder> *subfolders, FolderStats *stats);
+    void releaseParent(ParentFolder *parent);
+    void visit(const NativeWalkerPath &path, bool isFolder, long long size);
+
+    int flags;
+    FileSystemVisitor *visitor;
+    long long maxFiles;
+    long long maxFolders;
+    int rootLength;
+
+    QMutex mutex;
+    QWaitCondition condition;
+    QStack<PendingFolder> pendingFolders;
+    QAtomicInt openParentFolders;
+    QSet<QPair<unsigned long long, unsigned long long> > walkedFolders;
+    int activeWorkers;
+    int runningTasks;
+    QAtomicInt cancelled;
+    FolderStats totals;
+};
+
+#endif // FILESYSTEMWALKER_H
@@ -1,5 +1,7 @@
 #include "LinkProcessor.h"
 #include "Utilities.h"
+#include "Preferences.h"
+#include "PublicNodeCache.h"
 #include <QDir>
 #include <QDateTime>
 #include <QApplication>
@@ -16,10 +18,12 @@ LinkProcessor::LinkProcessor(QStringList linkList, MegaApi *megaApi, MegaApi *me
         linkSelected.append(true);
         linkNode.append(NULL);
         linkError.append(MegaError::API_ENOENT);
+        linkResolved.append(false);
     }
 
     importParentFolder = mega::INVALID_HANDLE;
     currentIndex = 0;
+    linkInfoRequestsInFlight = 0;
     remainingNodes = 0;
     importSuccess = 0;
     importFailed = 0;
@@ -46,6 +50,11 @@ bool LinkProcessor::isSelected(int id)
     return linkSelected[id];
 }
 
+bool LinkProcessor::isResolved(int id)
+{
+    return linkResolved[id];
+}
+
 int LinkProcessor::getError(int id)
 {
     return linkError[id];
@@ -65,31 +74,26 @@ void LinkProcessor::onRequestFinish(MegaApi *, MegaRequest *request, MegaError *
 {
     if (request->getType() == MegaRequest::TYPE_GET_PUBLIC_NODE)
     {
-        if (e->getErrorCode() != MegaError::API_OK)
-        {
-            linkNode[currentIndex] = NULL;
-        }
-        else
+        //Responses can arrive in any order, so they are matched by link
+        QString link = QString::fromUtf8(request->getLink());
+        QMultiHash<QString, int>::iterator it = linkInfoRequests.find(link);
+        if (it == linkInfoRequests.end())
         {
-            linkNode[currentIndex] = request->getPublicMegaNode();
+            return;
         }
+        int index = it.value();
+        linkInfoRequests.erase(it);
+        linkInfoRequestsInFlight--;
 
-        linkError[currentIndex] = e->getErrorCode();
-        linkSelected[currentIndex] = (linkError[currentIndex] == MegaError::API_OK);
-        if (!linkError[currentIndex])
-        {
-            QString name = QString::fromUtf8(linkNode[currentIndex]->getName());
-            if (!name.compare(QString::fromAscii("NO_KEY")) || !name.compare(QString::fromAscii("DECRYPTION_ERROR")))
-            {
-                linkSelected[currentIndex] = false;
-            }
-        }
-        currentIndex++;
-        emit onLinkInfoAvailable(currentIndex-1);
-        if (currentIndex == linkList.size())
+        MegaNode *node = NULL;
+        if (e->getErrorCode() == MegaError::API_OK)
         {
-            emit onLinkInfoRequestFinish();
+            node = request->getPublicMegaNode();
+            PublicNodeCache::instance()->addNode(link, node);
         }
+
+        processPendingLinkInfo();
+        linkInfoFinished(index, node, e->getErrorCode());
     }
     else if (request->getType() == MegaRequest::TYPE_CREATE_FOLDER)
     {
@@ -118,17 +122,62 @@ void LinkProcessor::onRequestFinish(MegaApi *, MegaRequest *request, MegaError *
 
 void LinkProcessor::requestLinkInfo()
 {
+    PublicNodeCache *cache = PublicNodeCache::instance();
     for (int i = 0; i < linkList.size(); i++)
     {
+        MegaNode *node = cache->getNode(linkList[i]);
+        if (node)
+        {
+            linkInfoFinished(i, node, MegaError::API_OK);
+        }
+        else
+        {
+            pendingLinkInfo.enqueue(i);
+        }
+    }
+    processPendingLinkInfo();
+}
+
+void LinkProcessor::processPendingLinkInfo()
+{
+    while (linkInfoRequestsInFlight < Preferences::MAX_LINK_INFO_REQUESTS_IN_FLIGHT
+           && !pendingLinkInfo.isEmpty())
+    {
+        int index = pendingLinkInfo.dequeue();
+        linkInfoRequests.insert(linkList[index], index);
+        linkInfoRequestsInFlight++;
         if (megaApiGuest)
         {
-            megaApiGuest->getPublicNode(linkList[i].toUtf8().constData(), delegateListener);
+            megaApiGuest->getPublicNode(linkList[index].toUtf8().constData(), delegateListener);
         }
         else
         {
-            megaApi->getPublicNode(linkList[i].toUtf8().constData(), delegateListener);
+            megaApi->getPublicNode(linkList[index].toUtf8().constData(), delegateListener);
+        }
+    }
+}
+
+void LinkProcessor::linkInfoFinished(int index, MegaNode *node, int error)
+{
+    linkNode[index] = node;
+    linkError[index] = error;
+    linkResolved[index] = true;
+    linkSelected[index] = (error == MegaError::API_OK);
+    if (!error)
+    {
+        QString name = QString::fromUtf8(node->getName());
+        if (!name.compare(QString::fromAscii("NO_KEY")) || !name.compare(QString::fromAscii("DECRYPTION_ERROR")))
+        {
+            linkSelected[index] = false;
         }
     }
+
+    currentIndex++;
+    emit onLinkInfoAvailable(index);
+    if (currentIndex == linkList.size())
+    {
+        emit onLinkInfoRequestFinish();
+    }
 }
 
 void LinkProcessor::importLinks(QString megaPath)
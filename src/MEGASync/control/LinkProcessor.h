@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QStringList>
+#include <QQueue>
+#include <QMultiHash>
 #include "megaapi.h"
 #include "QTMegaRequestListener.h"
 
@@ -18,6 +20,7 @@ public:
 
     QString getLink(int id);
     bool isSelected(int id);
+    bool isResolved(int id);
     int getError(int id);
     mega::MegaNode *getNode(int id);
     int size();
@@ -35,12 +38,19 @@ public:
     int getCurrentIndex();
 
 protected:
+    void processPendingLinkInfo();
+    void linkInfoFinished(int index, mega::MegaNode *node, int error);
+
     mega::MegaApi *megaApi;
     mega::MegaApi *megaApiGuest;
     QStringList linkList;
     QList<bool> linkSelected;
     QList<mega::MegaNode *> linkNode;
     QList<int> linkError;
+    QList<bool> linkResolved;
+    QQueue<int> pendingLinkInfo;
+    QMultiHash<QString, int> linkInfoRequests;
+    int linkInfoRequestsInFlight;
     int currentIndex;
     int remainingNodes;
     int importSuccess;
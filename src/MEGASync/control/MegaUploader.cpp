@@ -5,10 +5,6 @@
 #include <QtCore>
 #include <QApplication>
 
-#if QT_VERSION >= 0x050000
-#include <QtConcurrent/QtConcurrent>
-#endif
-
 using namespace mega;
 using namespace std;
 
@@ -16,6 +12,10 @@ MegaUploader::MegaUploader(MegaApi *megaApi) : QObject()
 {
     this->megaApi = megaApi;
     delegateListener = new QTMegaRequestListener(megaApi, this);
+    connect(&fileCopier, SIGNAL(copyProgress(QString, long long, long long)),
+            this, SIGNAL(localCopyProgress(QString, long long, long long)));
+    connect(&fileCopier, SIGNAL(copyFinished(QString, long long, long long, int, int)),
+            this, SIGNAL(localCopyFinished(QString, long long, long long, int, int)));
 }
 
 MegaUploader::~MegaUploader()
@@ -82,8 +82,18 @@ void MegaUploader::upload(QFileInfo info, MegaNode *parent)
 #else
         QString destPath = QDir::toNativeSeparators(QString::fromUtf8(localPath.data()) + QDir::separator() + info.fileName());
 #endif
+        //The source is already in place, moving the destination to the debris would remove it
+#ifdef WIN32
+        if (!destPath.compare(currentPath, Qt::CaseInsensitive))
+#else
+        if (destPath == currentPath)
+#endif
+        {
+            return;
+        }
+
         megaApi->moveToLocalDebris(destPath.toUtf8().constData());
-        QtConcurrent::run(Utilities::copyRecursively, currentPath, destPath);
+        fileCopier.copy(currentPath, destPath, Preferences::instance()->allowHardLinksInSyncs());
     }
     else if (info.isFile())
     {
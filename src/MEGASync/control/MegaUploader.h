@@ -8,6 +8,7 @@
 #include "Preferences.h"
 #include "megaapi.h"
 #include "QTMegaRequestListener.h"
+#include "FileCopier.h"
 
 class MegaUploader : public QObject, public mega::MegaRequestListener
 {
@@ -21,6 +22,8 @@ public:
 
 signals:
     void dupplicateUpload(QString localPath, QString name, mega::MegaHandle handle);
+    void localCopyProgress(QString localPath, long long copiedBytes, long long totalBytes);
+    void localCopyFinished(QString localPath, long long copiedBytes, long long clonedBytes, int numFiles, int numErrors);
 
 protected:
     void upload(QFileInfo info, mega::MegaNode *parent);
@@ -28,6 +31,8 @@ protected:
     mega::MegaApi *megaApi;
     mega::QTMegaRequestListener *delegateListener;
     QQueue<QFileInfo> folders;
+    //Copies the uploads that go to synced folders
+    FileCopier fileCopier;
 };
 
 #endif // MEGAUPLOADER_H
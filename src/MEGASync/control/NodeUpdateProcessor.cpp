@@ -0,0 +1,162 @@
+#include "NodeUpdateProcessor.h"
+#include "Preferences.h"
+#include <QtCore>
+
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrent>
+#endif
+
+using namespace mega;
+using namespace std;
+
+NodeUpdateSummary::NodeUpdateSummary()
+{
+    numNodes = 0;
+    externalNodes = 0;
+    nodesRemoved = false;
+    removedBytes = 0;
+    noKeyNodes = 0;
+    elapsedMs = 0;
+}
+
+NodeUpdateProcessor::NodeUpdateProcessor(long long lastExit, QObject *parent) : QObject(parent)
+{
+    this->lastExit = lastExit;
+    this->currentBatch = NULL;
+    connect(&watcher, SIGNAL(finished()), this, SLOT(onClassificationFinished()));
+}
+
+NodeUpdateProcessor::~NodeUpdateProcessor()
+{
+    //The worker can be using the current batch
+    watcher.waitForFinished();
+    delete currentBatch;
+    qDeleteAll(pendingBatches);
+}
+
+void NodeUpdateProcessor::processNodes(MegaNodeList *nodes)
+{
+    if (!nodes)
+    {
+        return;
+    }
+
+    pendingBatches.enqueue(nodes);
+    if (!currentBatch)
+    {
+        processNextBatch();
+    }
+}
+
+void NodeUpdateProcessor::onClassificationFinished()
+{
+    NodeUpdateSummary summary = watcher.result();
+    delete currentBatch;
+    currentBatch = NULL;
+
+    emit nodesProcessed(summary);
+
+    if (!currentBatch)
+    {
+        processNextBatch();
+    }
+}
+
+void NodeUpdateProcessor::processNextBatch()
+{
+    if (pendingBatches.isEmpty())
+    {
+        return;
+    }
+
+    //Sync roots are taken when the batch starts, so the syncs disabled
+    //by the previous batches aren't reported again
+    currentBatch = pendingBatches.dequeue();
+    watcher.setFuture(QtConcurrent::run(NodeUpdateProcessor::classifyNodes, currentBatch,
+                                        Preferences::instance()->getActiveSyncRoots(), lastExit));
+}
+
+NodeUpdateSummary NodeUpdateProcessor::classifyNodes(MegaNodeList *nodes, QHash<MegaHandle, int> activeSyncRoots, long long lastExit)
+{
+    NodeUpdateSummary summary;
+    long long startTime = QDateTime::currentMSecsSinceEpoch();
+    QList<int> uploadedNodes;
+
+    summary.numNodes = nodes->size();
+    for (int i = 0; i < nodes->size(); i++)
+    {
+        MegaNode *node = nodes->get(i);
+        if (node->getType() == MegaNode::TYPE_FOLDER
+                && activeSyncRoots.contains(node->getHandle()))
+        {
+            summary.syncRoots.append(node->getHandle());
+        }
+
+        if (!node->getTag() && !node->isRemoved()
+                && !node->isSyncDeleted()
+                && ((lastExit / 1000) < node->getCreationTime()))
+        {
+            summary.externalNodes++;
+        }
+
+        if (node->isRemoved() && (node->getType() == MegaNode::TYPE_FILE))
+        {
+            summary.removedBytes += node->getSize();
+            summary.nodesRemoved = true;
+        }
+
+        if (!node->isRemoved() && node->getTag()
+                && !node->isSyncDeleted()
+                && (node->getType() == MegaNode::TYPE_FILE))
+        {
+            if (node->getAttrString()->size())
+            {
+                summary.noKeyNodes++;
+            }
+            uploadedNodes.append(i);
+        }
+    }
+
+    //Only the last files fit in the list of recent files, so large batches
+    //skip the local path conversions for the rest of them
+    int firstRecentFile = 0;
+    if (summary.numNodes > Preferences::LARGE_NODE_UPDATE_BATCH)
+    {
+        firstRecentFile = qMax(0, uploadedNodes.size() - Preferences::MAX_RECENT_FILES_PER_NODE_UPDATE);
+    }
+
+    for (int i = 0; i < uploadedNodes.size(); i++)
+    {
+        MegaNode *node = nodes->get(uploadedNodes[i]);
+        if (i < firstRecentFile)
+        {
+            summary.skippedUploadTags.append(node->getTag());
+            continue;
+        }
+
+        NodeUpdateRecentFile recentFile;
+        recentFile.fileName = QString::fromUtf8(node->getName());
+        recentFile.handle = node->getHandle();
+        recentFile.tag = node->getTag();
+
+        //If the node has been uploaded by a synced folder
+        //the SDK provides its local path
+        string path = node->getLocalPath();
+        if (path.size())
+        {
+#ifdef WIN32
+            recentFile.localPath = QString::fromWCharArray((const wchar_t *)path.data());
+            if (recentFile.localPath.startsWith(QString::fromAscii("\\\\?\\")))
+            {
+                recentFile.localPath = recentFile.localPath.mid(4);
+            }
+#else
+            recentFile.localPath = QString::fromUtf8(path.data());
+#endif
+        }
+        summary.recentFiles.append(recentFile);
+    }
+
+    summary.elapsedMs = QDateTime::currentMSecsSinceEpoch() - startTime;
+    return summary;
+}
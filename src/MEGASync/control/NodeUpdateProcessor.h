@@ -0,0 +1,75 @@
+#ifndef NODEUPDATEPROCESSOR_H
+#define NODEUPDATEPROCESSOR_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QQueue>
+#include <QFutureWatcher>
+#include <megaapi.h>
+
+class NodeUpdateRecentFile
+{
+public:
+    QString fileName;
+    mega::MegaHandle handle;
+    //Empty if the SDK doesn't know it (regular uploads), then the tag is used
+    QString localPath;
+    int tag;
+};
+
+//Compact result of the classification of a batch of updated nodes
+class NodeUpdateSummary
+{
+public:
+    NodeUpdateSummary();
+
+    int numNodes;
+    int externalNodes;
+    bool nodesRemoved;
+    long long removedBytes;
+    //Active sync roots included in the batch
+    QList<mega::MegaHandle> syncRoots;
+    //Files uploaded by this client, in the same order as in the batch.
+    //For large batches, only the last ones
+    QList<NodeUpdateRecentFile> recentFiles;
+    //Transfer tags of uploaded files not included in recentFiles
+    QList<int> skippedUploadTags;
+    //Nodes created by this client without a valid key
+    int noKeyNodes;
+    long long elapsedMs;
+};
+
+//Classifies the MegaNodeList of onNodesUpdate in the global thread pool.
+//Batches are processed one by one and in order, only the summary is
+//delivered to the GUI thread
+class NodeUpdateProcessor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NodeUpdateProcessor(long long lastExit, QObject *parent = 0);
+    virtual ~NodeUpdateProcessor();
+
+    //Takes the ownership of the list
+    void processNodes(mega::MegaNodeList *nodes);
+
+signals:
+    void nodesProcessed(const NodeUpdateSummary &summary);
+
+protected slots:
+    void onClassificationFinished();
+
+protected:
+    void processNextBatch();
+    static NodeUpdateSummary classifyNodes(mega::MegaNodeList *nodes,
+                                           QHash<mega::MegaHandle, int> activeSyncRoots,
+                                           long long lastExit);
+
+    long long lastExit;
+    QFutureWatcher<NodeUpdateSummary> watcher;
+    QQueue<mega::MegaNodeList *> pendingBatches;
+    mega::MegaNodeList *currentBatch;
+};
+
+#endif // NODEUPDATEPROCESSOR_H
@@ -2,6 +2,7 @@
 #include "platform/Platform.h"
 
 #include <QDesktopServices>
+#include <QCoreApplication>
 #include <assert.h>
 
 using namespace mega;
@@ -32,6 +33,23 @@ const long long Preferences::MIN_UPDATE_STATS_INTERVAL  = 300000;
 const long long Preferences::MIN_UPDATE_NOTIFICATION_INTERVAL_MS    = 172800000;
 const long long Preferences::MIN_REBOOT_INTERVAL_MS                 = 300000;
 const long long Preferences::MIN_EXTERNAL_NODES_WARNING_MS          = 60000;
+const int Preferences::MAX_EXPORT_REQUESTS_IN_FLIGHT                = 32;
+const int Preferences::MAX_LINK_INFO_REQUESTS_IN_FLIGHT             = 16;
+const int Preferences::PUBLIC_NODE_CACHE_SIZE                       = 5000;
+const long long Preferences::PUBLIC_NODE_CACHE_TTL_MS               = 900000;
+const int Preferences::TRANSFER_STATS_PUBLISH_INTERVAL_MS           = 250;
+const int Preferences::LARGE_NODE_UPDATE_BATCH                      = 1000;
+const int Preferences::MAX_RECENT_FILES_PER_NODE_UPDATE             = 3;
+const int Preferences::SETTINGS_SYNC_DELAY_MS                       = 2000;
+const int Preferences::SYNC_RESCAN_MAX_ENTRIES_PER_SECOND           = 2000;
+const int Preferences::SYNC_RESCAN_PROGRESS_INTERVAL_MS             = 1000;
+const int Preferences::DEBRIS_RETENTION_INTERVAL_MS                 = 3600000;
+const int Preferences::DEBRIS_RETENTION_DAYS                        = 30;
+const int Preferences::LOCAL_COPY_PROGRESS_INTERVAL_MS              = 1000;
+const int Preferences::SYNC_SIZE_REPORT_MAX_FOLDERS                 = 5;
+const int Preferences::SYNC_RESUME_SCAN_TIMEOUT_MS                  = 300000;
+const int Preferences::NODE_MODEL_PAGE_SIZE                         = 500;
+const int Preferences::SETTINGS_FORMAT                              = EncryptedSettings::FORMAT_BLOB;
 
 const unsigned int Preferences::UPDATE_INITIAL_DELAY_SECS           = 60;
 const unsigned int Preferences::UPDATE_RETRY_INTERVAL_SECS          = 7200;
@@ -117,6 +135,7 @@ const QString Preferences::UPDATE_BACKUP_FOLDER_NAME        = QString::fromAscii
 const QString Preferences::PROXY_TEST_URL                   = QString::fromUtf8("http://eu.static.mega.co.nz/?");
 const QString Preferences::PROXY_TEST_SUBSTRING             = QString::fromUtf8("<title>MEGA</title>");
 const QString Preferences::syncsGroupKey            = QString::fromAscii("Syncs");
+const QString Preferences::syncIdsKey               = QString::fromAscii("syncIds");
 const QString Preferences::currentAccountKey        = QString::fromAscii("currentAccount");
 const QString Preferences::emailKey                 = QString::fromAscii("email");
 const QString Preferences::emailHashKey             = QString::fromAscii("emailHash");
@@ -145,6 +164,10 @@ const QString Preferences::startOnStartupKey        = QString::fromAscii("startO
 const QString Preferences::languageKey              = QString::fromAscii("language");
 const QString Preferences::updateAutomaticallyKey   = QString::fromAscii("updateAutomatically");
 const QString Preferences::uploadLimitKBKey         = QString::fromAscii("uploadLimitKB");
+const QString Preferences::maxConcurrentSyncResumesKey  = QString::fromAscii("maxConcurrentSyncResumes");
+const QString Preferences::debrisMaxAgeDaysKey      = QString::fromAscii("debrisMaxAgeDays");
+const QString Preferences::debrisMaxSizeMBKey       = QString::fromAscii("debrisMaxSizeMB");
+const QString Preferences::allowHardLinksInSyncsKey = QString::fromAscii("allowHardLinksInSyncs");
 const QString Preferences::upperSizeLimitKey        = QString::fromAscii("upperSizeLimit");
 const QString Preferences::lowerSizeLimitKey        = QString::fromAscii("lowerSizeLimit");
 
@@ -185,6 +208,7 @@ const QString Preferences::localPathKey             = QString::fromAscii("localP
 const QString Preferences::localFingerprintKey      = QString::fromAscii("localFingerprint");
 const QString Preferences::fileTimeKey              = QString::fromAscii("fileTime");
 const QString Preferences::isCrashedKey             = QString::fromAscii("isCrashed");
+const QString Preferences::needsFullReloadKey       = QString::fromAscii("needsFullReload");
 const QString Preferences::wasPausedKey             = QString::fromAscii("wasPaused");
 const QString Preferences::lastExecutionTimeKey     = QString::fromAscii("lastExecutionTime");
 const QString Preferences::excludedSyncNamesKey     = QString::fromAscii("excludedSyncNames");
@@ -215,6 +239,10 @@ const bool Preferences::defaultLowerSizeLimit       = false;
 const bool Preferences::defaultUseHttpsOnly         = false;
 const bool Preferences::defaultSSLcertificateException = false;
 const int  Preferences::defaultUploadLimitKB        = -1;
+const int  Preferences::defaultMaxConcurrentSyncResumes = 4;
+const int  Preferences::defaultDebrisMaxAgeDays     = 0;
+const long long Preferences::defaultDebrisMaxSizeMB = 0;
+const bool Preferences::defaultAllowHardLinksInSyncs = false;
 const int Preferences::defaultTransferDownloadMethod      = MegaApi::TRANSFER_METHOD_AUTO;
 const int Preferences::defaultTransferUploadMethod        = MegaApi::TRANSFER_METHOD_AUTO;
 const long long  Preferences::defaultUpperSizeLimitValue              = 0;
@@ -268,7 +296,15 @@ void Preferences::initialize()
     bool retryFlag = false;
 
     errorFlag = false;
-    settings = new EncryptedSettings(settingsFile);
+    settings = new EncryptedSettings(settingsFile, SETTINGS_FORMAT);
+
+    if (!syncTimer && QCoreApplication::instance())
+    {
+        syncTimer = new QTimer(this);
+        syncTimer->setSingleShot(true);
+        syncTimer->setInterval(SETTINGS_SYNC_DELAY_MS);
+        connect(syncTimer, SIGNAL(timeout()), this, SLOT(syncPendingChanges()));
+    }
 
     QString currentAccount = settings->value(currentAccountKey).toString();
     if (currentAccount.size())
@@ -297,8 +333,11 @@ void Preferences::initialize()
 
         if (QFile::rename(bakSettingsFile,settingsFile))
         {
+            //The blob has the same contents as the file that failed
+            QFile::remove(EncryptedSettings::blobFileName(settingsFile));
+
             delete settings;
-            settings = new EncryptedSettings(settingsFile);
+            settings = new EncryptedSettings(settingsFile, SETTINGS_FORMAT);
 
             //Retry with backup file
             currentAccount = settings->value(currentAccountKey).toString();
@@ -325,7 +364,9 @@ void Preferences::initialize()
 
 Preferences::Preferences() : QObject(), mutex(QMutex::Recursive)
 {
-
+    nextSyncId = 0;
+    syncTimer = NULL;
+    pendingSync = false;
 }
 
 QString Preferences::email()
@@ -342,7 +383,7 @@ void Preferences::setEmail(QString email)
     mutex.lock();
     login(email);
     settings->setValue(emailKey, email);
-    settings->sync();
+    sync();
     mutex.unlock();
     emit stateChanged();
 }
@@ -372,7 +413,7 @@ void Preferences::setSession(QString session)
     settings->setValue(sessionKey, session);
     settings->remove(emailHashKey);
     settings->remove(privatePwKey);
-    settings->sync();
+    sync();
     mutex.unlock();
 }
 
@@ -722,7 +763,7 @@ void Preferences::setShowNotifications(bool value)
     mutex.lock();
     assert(logged());
     settings->setValue(showNotificationsKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -738,7 +779,7 @@ void Preferences::setStartOnStartup(bool value)
 {
     mutex.lock();
     settings->setValue(startOnStartupKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -754,7 +795,7 @@ void Preferences::setUseHttpsOnly(bool value)
 {
     mutex.lock();
     settings->setValue(useHttpsOnlyKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -790,7 +831,7 @@ void Preferences::setSSLcertificateException(bool value)
     {
         settings->beginGroup(currentAccount);
     }
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -806,7 +847,7 @@ void Preferences::setTransferDownloadMethod(int value)
 {
     mutex.lock();
     settings->setValue(transferDownloadMethodKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -822,7 +863,7 @@ void Preferences::setTransferUploadMethod(int value)
 {
     mutex.lock();
     settings->setValue(transferUploadMethodKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -838,7 +879,7 @@ void Preferences::setLanguage(QString &value)
 {
     mutex.lock();
     settings->setValue(languageKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -854,7 +895,7 @@ void Preferences::setUpdateAutomatically(bool value)
 {
     mutex.lock();
     settings->setValue(updateAutomaticallyKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -886,7 +927,7 @@ void Preferences::setHasDefaultUploadFolder(bool value)
 {
     mutex.lock();
     settings->setValue(hasDefaultUploadFolderKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -894,7 +935,7 @@ void Preferences::setHasDefaultDownloadFolder(bool value)
 {
     mutex.lock();
     settings->setValue(hasDefaultDownloadFolderKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -902,7 +943,7 @@ void Preferences::setHasDefaultImportFolder(bool value)
 {
     mutex.lock();
     settings->setValue(hasDefaultImportFolderKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -942,7 +983,77 @@ void Preferences::setUploadLimitKB(int value)
     mutex.lock();
     assert(logged());
     settings->setValue(uploadLimitKBKey, value);
-    settings->sync();
+    requestSync();
+    mutex.unlock();
+}
+
+int Preferences::maxConcurrentSyncResumes()
+{
+    mutex.lock();
+    assert(logged());
+    int value = settings->value(maxConcurrentSyncResumesKey, defaultMaxConcurrentSyncResumes).toInt();
+    mutex.unlock();
+    return qMax(value, 1);
+}
+
+void Preferences::setMaxConcurrentSyncResumes(int value)
+{
+    mutex.lock();
+    assert(logged());
+    settings->setValue(maxConcurrentSyncResumesKey, value);
+    requestSync();
+    mutex.unlock();
+}
+
+int Preferences::debrisMaxAgeDays()
+{
+    mutex.lock();
+    assert(logged());
+    int value = settings->value(debrisMaxAgeDaysKey, defaultDebrisMaxAgeDays).toInt();
+    mutex.unlock();
+    return qMax(value, 0);
+}
+
+void Preferences::setDebrisMaxAgeDays(int value)
+{
+    mutex.lock();
+    assert(logged());
+    settings->setValue(debrisMaxAgeDaysKey, value);
+    requestSync();
+    mutex.unlock();
+}
+
+long long Preferences::debrisMaxSizeMB()
+{
+    mutex.lock();
+    assert(logged());
+    long long value = settings->value(debrisMaxSizeMBKey, defaultDebrisMaxSizeMB).toLongLong();
+    mutex.unlock();
+    return qMax(value, 0LL);
+}
+
+void Preferences::setDebrisMaxSizeMB(long long value)
+{
+    mutex.lock();
+    assert(logged());
+    settings->setValue(debrisMaxSizeMBKey, value);
+    requestSync();
+    mutex.unlock();
+}
+
+bool Preferences::allowHardLinksInSyncs()
+{
+    mutex.lock();
+    bool value = settings->value(allowHardLinksInSyncsKey, defaultAllowHardLinksInSyncs).toBool();
+    mutex.unlock();
+    return value;
+}
+
+void Preferences::setAllowHardLinksInSyncs(bool value)
+{
+    mutex.lock();
+    settings->setValue(allowHardLinksInSyncsKey, value);
+    requestSync();
     mutex.unlock();
 }
 
@@ -958,7 +1069,7 @@ void Preferences::setUpperSizeLimit(bool value)
 {
     mutex.lock();
     settings->setValue(upperSizeLimitKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -975,7 +1086,7 @@ void Preferences::setUpperSizeLimitValue(long long value)
     mutex.lock();
     assert(logged());
     settings->setValue(upperSizeLimitValueKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -992,7 +1103,7 @@ void Preferences::setUpperSizeLimitUnit(int value)
     mutex.lock();
     assert(logged());
     settings->setValue(upperSizeLimitUnitKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1008,7 +1119,7 @@ void Preferences::setLowerSizeLimit(bool value)
 {
     mutex.lock();
     settings->setValue(lowerSizeLimitKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1025,7 +1136,7 @@ void Preferences::setLowerSizeLimitValue(long long value)
     mutex.lock();
     assert(logged());
     settings->setValue(lowerSizeLimitValueKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1042,7 +1153,7 @@ void Preferences::setLowerSizeLimitUnit(int value)
     mutex.lock();
     assert(logged());
     settings->setValue(lowerSizeLimitUnitKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1058,7 +1169,7 @@ void Preferences::setFolderPermissionsValue(int permissions)
 {
     mutex.lock();
     settings->setValue(folderPermissionsKey, permissions);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1074,7 +1185,7 @@ void Preferences::setFilePermissionsValue(int permissions)
 {
     mutex.lock();
     settings->setValue(filePermissionsKey, permissions);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1090,7 +1201,7 @@ void Preferences::setProxyType(int value)
 {
     mutex.lock();
     settings->setValue(proxyTypeKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1106,7 +1217,7 @@ void Preferences::setProxyProtocol(int value)
 {
     mutex.lock();
     settings->setValue(proxyProtocolKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1122,7 +1233,7 @@ void Preferences::setProxyServer(const QString &value)
 {
     mutex.lock();
     settings->setValue(proxyServerKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1138,7 +1249,7 @@ void Preferences::setProxyPort(int value)
 {
     mutex.lock();
     settings->setValue(proxyPortKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1154,7 +1265,7 @@ void Preferences::setProxyRequiresAuth(bool value)
 {
     mutex.lock();
     settings->setValue(proxyRequiresAuthKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1170,7 +1281,7 @@ void Preferences::setProxyUsername(const QString &value)
 {
     mutex.lock();
     settings->setValue(proxyUsernameKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1186,7 +1297,7 @@ void Preferences::setProxyPassword(const QString &value)
 {
     mutex.lock();
     settings->setValue(proxyPasswordKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1228,7 +1339,7 @@ void Preferences::setInstallationTime(long long time)
 {
     mutex.lock();
     settings->setValue(installationTimeKey, time);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 long long Preferences::accountCreationTime()
@@ -1242,7 +1353,7 @@ void Preferences::setAccountCreationTime(long long time)
 {
     mutex.lock();
     settings->setValue(accountCreationTimeKey, time);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 
 }
@@ -1257,7 +1368,7 @@ void Preferences::setHasLoggedIn(long long time)
 {
     mutex.lock();
     settings->setValue(hasLoggedInKey, time);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1273,7 +1384,7 @@ void Preferences::setFirstStartDone(bool value)
 {
     mutex.lock();
     settings->setValue(firstStartDoneKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1289,7 +1400,7 @@ void Preferences::setFirstSyncDone(bool value)
 {
     mutex.lock();
     settings->setValue(firstSyncDoneKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1305,7 +1416,7 @@ void Preferences::setFirstFileSynced(bool value)
 {
     mutex.lock();
     settings->setValue(firstFileSyncedKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1321,7 +1432,7 @@ void Preferences::setFirstWebDownloadDone(bool value)
 {
     mutex.lock();
     settings->setValue(firstWebDownloadKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1337,7 +1448,7 @@ void Preferences::setLastCustomStreamingApp(const QString &value)
 {
     mutex.lock();
     settings->setValue(lastCustomStreamingAppKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1345,7 +1456,7 @@ void Preferences::setLastExecutionTime(qint64 time)
 {
     mutex.lock();
     settings->setValue(lastExecutionTimeKey, time);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1363,7 +1474,7 @@ void Preferences::setLastUpdateTime(long long time)
     mutex.lock();
     assert(logged());
     settings->setValue(lastUpdateTimeKey, time);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1381,7 +1492,7 @@ void Preferences::setLastUpdateVersion(int version)
     mutex.lock();
     assert(logged());
     settings->setValue(lastUpdateVersionKey, version);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1397,7 +1508,7 @@ void Preferences::setDownloadFolder(QString value)
 {
     mutex.lock();
     settings->setValue(downloadFolderKey, QDir::toNativeSeparators(value));
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1415,7 +1526,7 @@ void Preferences::setUploadFolder(long long value)
     mutex.lock();
     assert(logged());
     settings->setValue(uploadFolderKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1433,14 +1544,14 @@ void Preferences::setImportFolder(long long value)
     mutex.lock();
     assert(logged());
     settings->setValue(importFolderKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
 int Preferences::getNumSyncedFolders()
 {
     mutex.lock();
-    int value = localFolders.length();
+    int value = syncConfigs.size();
     mutex.unlock();
     return value;
 }
@@ -1448,13 +1559,13 @@ int Preferences::getNumSyncedFolders()
 QString Preferences::getSyncName(int num)
 {
     mutex.lock();
-    assert(logged() && (syncNames.size()>num));
-    if (num >= syncNames.size())
+    assert(logged() && (syncConfigs.size()>num));
+    if (num >= syncConfigs.size())
     {
         mutex.unlock();
         return QString();
     }
-    QString value = syncNames.at(num);
+    QString value = syncConfigs.at(num).name;
     mutex.unlock();
     return value;
 }
@@ -1462,18 +1573,18 @@ QString Preferences::getSyncName(int num)
 QString Preferences::getLocalFolder(int num)
 {
     mutex.lock();
-    assert(logged() && (localFolders.size()>num));
-    if (num >= localFolders.size())
+    assert(logged() && (syncConfigs.size()>num));
+    if (num >= syncConfigs.size())
     {
         mutex.unlock();
         return QString();
     }
 
-    QFileInfo fileInfo(localFolders.at(num));
+    QFileInfo fileInfo(syncConfigs.at(num).localFolder);
     QString value = QDir::toNativeSeparators(fileInfo.canonicalFilePath());
     if (value.isEmpty())
     {
-        value = QDir::toNativeSeparators(localFolders.at(num));
+        value = QDir::toNativeSeparators(syncConfigs.at(num).localFolder);
     }
 
     mutex.unlock();
@@ -1483,13 +1594,13 @@ QString Preferences::getLocalFolder(int num)
 QString Preferences::getMegaFolder(int num)
 {
     mutex.lock();
-    assert(logged() && (megaFolders.size()>num));
-    if (num >= megaFolders.size())
+    assert(logged() && (syncConfigs.size()>num));
+    if (num >= syncConfigs.size())
     {
         mutex.unlock();
         return QString();
     }
-    QString value = megaFolders.at(num);
+    QString value = syncConfigs.at(num).megaFolder;
     mutex.unlock();
     return value;
 }
@@ -1497,13 +1608,13 @@ QString Preferences::getMegaFolder(int num)
 long long Preferences::getLocalFingerprint(int num)
 {
     mutex.lock();
-    assert(logged() && (localFingerprints.size()>num));
-    if (num >= localFingerprints.size())
+    assert(logged() && (syncConfigs.size()>num));
+    if (num >= syncConfigs.size())
     {
         mutex.unlock();
         return 0;
     }
-    long long value = localFingerprints.at(num);
+    long long value = syncConfigs.at(num).localFingerprint;
     mutex.unlock();
     return value;
 }
@@ -1511,26 +1622,27 @@ long long Preferences::getLocalFingerprint(int num)
 void Preferences::setLocalFingerprint(int num, long long fingerprint)
 {
     mutex.lock();
-    if (num >= localFingerprints.size())
+    if (num >= syncConfigs.size())
     {
         mutex.unlock();
         return;
     }
-    localFingerprints[num] = fingerprint;
-    writeFolders();
+    syncConfigs[num].localFingerprint = fingerprint;
+    writeSyncConfig(syncConfigs.at(num));
+    requestSync();
     mutex.unlock();
 }
 
 MegaHandle Preferences::getMegaFolderHandle(int num)
 {
     mutex.lock();
-    assert(logged() && (megaFolderHandles.size()>num));
-    if (num >= megaFolderHandles.size())
+    assert(logged() && (syncConfigs.size()>num));
+    if (num >= syncConfigs.size())
     {
         mutex.unlock();
         return mega::INVALID_HANDLE;
     }
-    long long value = megaFolderHandles.at(num);
+    MegaHandle value = syncConfigs.at(num).megaFolderHandle;
     mutex.unlock();
     return value;
 }
@@ -1538,12 +1650,12 @@ MegaHandle Preferences::getMegaFolderHandle(int num)
 bool Preferences::isFolderActive(int num)
 {
     mutex.lock();
-    if (num >= activeFolders.size())
+    if (num >= syncConfigs.size())
     {
         mutex.unlock();
         return false;
     }
-    bool value = activeFolders.at(num);
+    bool value = syncConfigs.at(num).active;
     mutex.unlock();
     return value;
 }
@@ -1551,12 +1663,12 @@ bool Preferences::isFolderActive(int num)
 bool Preferences::isTemporaryInactiveFolder(int num)
 {
     mutex.lock();
-    if (num >= temporaryInactiveFolders.size())
+    if (num >= syncConfigs.size())
     {
         mutex.unlock();
         return false;
     }
-    bool value = temporaryInactiveFolders.at(num);
+    bool value = syncConfigs.at(num).temporaryInactive;
     mutex.unlock();
     return value;
 }
@@ -1564,26 +1676,72 @@ bool Preferences::isTemporaryInactiveFolder(int num)
 void Preferences::setSyncState(int num, bool enabled, bool temporaryDisabled)
 {
     mutex.lock();
-    if (num >= activeFolders.size() || num >= temporaryInactiveFolders.size())
+    if (num >= syncConfigs.size())
     {
         mutex.unlock();
         return;
     }
-    activeFolders[num] = enabled;
-    temporaryInactiveFolders[num] = temporaryDisabled;
-    writeFolders();
+    syncConfigs[num].active = enabled;
+    syncConfigs[num].temporaryInactive = temporaryDisabled;
+    QString localFolder = syncConfigs.at(num).localFolder;
+    QString syncName = syncConfigs.at(num).name;
+    updateSyncIndexes();
+    writeSyncConfig(syncConfigs.at(num));
+    sync();
     mutex.unlock();
 
     if (enabled)
     {
-        Platform::syncFolderAdded(localFolders[num], syncNames[num]);
+        Platform::syncFolderAdded(localFolder, syncName);
+    }
+}
+
+int Preferences::getSyncId(int num)
+{
+    mutex.lock();
+    if (num >= syncConfigs.size())
+    {
+        mutex.unlock();
+        return -1;
     }
+    int value = syncConfigs.at(num).id;
+    mutex.unlock();
+    return value;
+}
+
+int Preferences::getSyncIndexById(int syncId)
+{
+    mutex.lock();
+    int value = syncIndexesById.value(syncId, -1);
+    mutex.unlock();
+    return value;
+}
+
+int Preferences::getSyncIndexByHandle(MegaHandle handle)
+{
+    mutex.lock();
+    int value = syncIndexesByHandle.value(handle, -1);
+    mutex.unlock();
+    return value;
+}
+
+int Preferences::getSyncIndexByLocalPath(QString localPath)
+{
+    QString key = syncPathKey(localPath);
+    mutex.lock();
+    int value = syncIndexesByLocalPath.value(key, -1);
+    mutex.unlock();
+    return value;
 }
 
 QStringList Preferences::getSyncNames()
 {
     mutex.lock();
-    QStringList value = syncNames;
+    QStringList value;
+    for (int i = 0; i < syncConfigs.size(); i++)
+    {
+        value.append(syncConfigs.at(i).name);
+    }
     mutex.unlock();
     return value;
 }
@@ -1591,7 +1749,11 @@ QStringList Preferences::getSyncNames()
 QStringList Preferences::getMegaFolders()
 {
     mutex.lock();
-    QStringList value = megaFolders;
+    QStringList value;
+    for (int i = 0; i < syncConfigs.size(); i++)
+    {
+        value.append(syncConfigs.at(i).megaFolder);
+    }
     mutex.unlock();
     return value;
 }
@@ -1599,7 +1761,11 @@ QStringList Preferences::getMegaFolders()
 QStringList Preferences::getLocalFolders()
 {
     mutex.lock();
-    QStringList value = localFolders;
+    QStringList value;
+    for (int i = 0; i < syncConfigs.size(); i++)
+    {
+        value.append(syncConfigs.at(i).localFolder);
+    }
     mutex.unlock();
     return value;
 }
@@ -1607,7 +1773,19 @@ QStringList Preferences::getLocalFolders()
 QList<long long> Preferences::getMegaFolderHandles()
 {
     mutex.lock();
-    QList<long long> value = megaFolderHandles;
+    QList<long long> value;
+    for (int i = 0; i < syncConfigs.size(); i++)
+    {
+        value.append(syncConfigs.at(i).megaFolderHandle);
+    }
+    mutex.unlock();
+    return value;
+}
+
+QHash<MegaHandle, int> Preferences::getActiveSyncRoots()
+{
+    mutex.lock();
+    QHash<MegaHandle, int> value = activeSyncRoots;
     mutex.unlock();
     return value;
 }
@@ -1631,14 +1809,20 @@ void Preferences::addSyncedFolder(QString localFolder, QString megaFolder, mega:
     syncName.remove(QChar::fromAscii(':')).remove(QDir::separator());
 
     localFolder = QDir::toNativeSeparators(localFolderInfo.canonicalFilePath());
-    syncNames.append(syncName);
-    localFolders.append(localFolder);
-    megaFolders.append(megaFolder);
-    megaFolderHandles.append(megaFolderHandle);
-    activeFolders.append(active);
-    temporaryInactiveFolders.append(false);
-    localFingerprints.append(0);
-    writeFolders();
+    SyncConfig syncConfig;
+    syncConfig.id = nextSyncId++;
+    syncConfig.name = syncName;
+    syncConfig.localFolder = localFolder;
+    syncConfig.megaFolder = megaFolder;
+    syncConfig.megaFolderHandle = megaFolderHandle;
+    syncConfig.localFingerprint = 0;
+    syncConfig.active = active;
+    syncConfig.temporaryInactive = false;
+    syncConfigs.append(syncConfig);
+    updateSyncIndexes();
+    writeSyncConfig(syncConfig);
+    writeSyncIds();
+    sync();
     mutex.unlock();
     Platform::syncFolderAdded(localFolder, syncName);
 }
@@ -1646,13 +1830,15 @@ void Preferences::addSyncedFolder(QString localFolder, QString megaFolder, mega:
 void Preferences::setMegaFolderHandle(int num, MegaHandle handle)
 {
     mutex.lock();
-    if (num >= megaFolderHandles.size())
+    if (num >= syncConfigs.size())
     {
         mutex.unlock();
         return;
     }
-    megaFolderHandles[num] = handle;
-    writeFolders();
+    syncConfigs[num].megaFolderHandle = handle;
+    updateSyncIndexes();
+    writeSyncConfig(syncConfigs.at(num));
+    sync();
     mutex.unlock();
 }
 
@@ -1660,14 +1846,19 @@ void Preferences::removeSyncedFolder(int num)
 {
     mutex.lock();
     assert(logged());
-    syncNames.removeAt(num);
-    localFolders.removeAt(num);
-    megaFolders.removeAt(num);
-    megaFolderHandles.removeAt(num);
-    activeFolders.removeAt(num);
-    temporaryInactiveFolders.removeAt(num);
-    localFingerprints.removeAt(num);
-    writeFolders();
+    if (num >= syncConfigs.size())
+    {
+        mutex.unlock();
+        return;
+    }
+
+    settings->beginGroup(syncsGroupKey);
+    settings->remove(QString::number(syncConfigs.at(num).id));
+    settings->endGroup();
+    syncConfigs.removeAt(num);
+    updateSyncIndexes();
+    writeSyncIds();
+    sync();
     mutex.unlock();
 }
 
@@ -1676,19 +1867,16 @@ void Preferences::removeAllFolders()
     mutex.lock();
     assert(logged());
 
-    for (int i = 0; i < localFolders.size(); i++)
+    for (int i = 0; i < syncConfigs.size(); i++)
     {
-        Platform::syncFolderRemoved(localFolders[i], syncNames[i]);
+        Platform::syncFolderRemoved(syncConfigs.at(i).localFolder, syncConfigs.at(i).name);
     }
 
-    syncNames.clear();
-    localFolders.clear();
-    megaFolders.clear();
-    megaFolderHandles.clear();
-    activeFolders.clear();
-    temporaryInactiveFolders.clear();
-    localFingerprints.clear();
-    writeFolders();
+    clearSyncs();
+    settings->beginGroup(syncsGroupKey);
+    settings->remove(QString::fromAscii(""));
+    settings->endGroup();
+    sync();
     mutex.unlock();
 }
 
@@ -1715,7 +1903,7 @@ void Preferences::setExcludedSyncNames(QStringList names)
         settings->setValue(excludedSyncNamesKey, excludedSyncNames.join(QString::fromAscii("\n")));
     }
 
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1763,7 +1951,7 @@ void Preferences::setPreviousCrashes(QStringList crashes)
         settings->beginGroup(currentAccount);
     }
 
-    settings->sync();
+    sync();
     mutex.unlock();
 }
 
@@ -1805,7 +1993,7 @@ void Preferences::setLastReboot(long long value)
         settings->beginGroup(currentAccount);
     }
 
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1847,7 +2035,7 @@ void Preferences::setLastExit(long long value)
         settings->beginGroup(currentAccount);
     }
 
-    settings->sync();
+    sync();
     mutex.unlock();
 }
 
@@ -1881,13 +2069,7 @@ void Preferences::leaveUser()
     assert(logged());
     settings->endGroup();
 
-    syncNames.clear();
-    localFolders.clear();
-    megaFolders.clear();
-    megaFolderHandles.clear();
-    activeFolders.clear();
-    temporaryInactiveFolders.clear();
-    localFingerprints.clear();
+    clearSyncs();
     mutex.unlock();
 }
 
@@ -1901,14 +2083,8 @@ void Preferences::unlink()
     settings->endGroup();
 
     settings->remove(currentAccountKey);
-    syncNames.clear();
-    localFolders.clear();
-    megaFolders.clear();
-    megaFolderHandles.clear();
-    activeFolders.clear();
-    temporaryInactiveFolders.clear();
-    localFingerprints.clear();
-    settings->sync();
+    clearSyncs();
+    sync();
     mutex.unlock();
     emit stateChanged();
 }
@@ -1925,7 +2101,23 @@ void Preferences::setCrashed(bool value)
 {
     mutex.lock();
     settings->setValue(isCrashedKey, value);
-    settings->sync();
+    sync();
+    mutex.unlock();
+}
+
+bool Preferences::needsFullReload()
+{
+    mutex.lock();
+    bool value = settings->value(needsFullReloadKey, false).toBool();
+    mutex.unlock();
+    return value;
+}
+
+void Preferences::setNeedsFullReload(bool value)
+{
+    mutex.lock();
+    settings->setValue(needsFullReloadKey, value);
+    sync();
     mutex.unlock();
 }
 
@@ -1941,7 +2133,7 @@ void Preferences::setWasPaused(bool value)
 {
     mutex.lock();
     settings->setValue(wasPausedKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1957,7 +2149,7 @@ void Preferences::setLastStatsRequest(long long value)
 {
     mutex.lock();
     settings->setValue(lastStatsRequestKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1973,7 +2165,7 @@ void Preferences::disableOverlayIcons(bool value)
 {
     mutex.lock();
     settings->setValue(disableOverlayIconsKey, value);
-    settings->sync();
+    requestSync();
     mutex.unlock();
 }
 
@@ -1991,13 +2183,44 @@ void Preferences::clearAll()
     }
 
     settings->clear();
-    settings->sync();
+    sync();
     mutex.unlock();
 }
 
 void Preferences::sync()
 {
+    mutex.lock();
+    pendingSync = false;
     settings->sync();
+    mutex.unlock();
+}
+
+void Preferences::requestSync()
+{
+    mutex.lock();
+    if (!syncTimer)
+    {
+        //No event loop to delay the write (i.e. uninstallation)
+        pendingSync = false;
+        settings->sync();
+    }
+    else if (!pendingSync)
+    {
+        pendingSync = true;
+        QMetaObject::invokeMethod(syncTimer, "start", Qt::QueuedConnection);
+    }
+    mutex.unlock();
+}
+
+void Preferences::syncPendingChanges()
+{
+    mutex.lock();
+    if (pendingSync)
+    {
+        pendingSync = false;
+        settings->sync();
+    }
+    mutex.unlock();
 }
 
 void Preferences::login(QString account)
@@ -2017,7 +2240,7 @@ void Preferences::login(QString account)
         }
         settings->setValue(lastVersionKey, Preferences::VERSION_CODE);
     }
-    settings->sync();
+    sync();
     mutex.unlock();
 }
 
@@ -2056,13 +2279,7 @@ void Preferences::logout()
     {
         settings->endGroup();
     }
-    syncNames.clear();
-    localFolders.clear();
-    megaFolders.clear();
-    megaFolderHandles.clear();
-    activeFolders.clear();
-    temporaryInactiveFolders.clear();
-    localFingerprints.clear();
+    clearSyncs();
     mutex.unlock();
 }
 
@@ -2105,58 +2322,128 @@ void Preferences::readFolders()
 {
     mutex.lock();
     assert(logged());
-    syncNames.clear();
-    localFolders.clear();
-    megaFolders.clear();
-    megaFolderHandles.clear();
-    activeFolders.clear();
-    temporaryInactiveFolders.clear();
-    localFingerprints.clear();
+    clearSyncs();
 
     settings->beginGroup(syncsGroupKey);
-    int numSyncs = settings->numChildGroups();
-    for (int i = 0; i < numSyncs; i++)
-    {
-        settings->beginGroup(QString::number(i));
 
-        syncNames.append(settings->value(syncNameKey).toString());
-        localFolders.append(settings->value(localFolderKey).toString());
-        megaFolders.append(settings->value(megaFolderKey).toString());
-        megaFolderHandles.append(settings->value(megaFolderHandleKey).toLongLong());
-        activeFolders.append(settings->value(folderActiveKey, true).toBool());
-        temporaryInactiveFolders.append(settings->value(temporaryInactiveKey, false).toBool());
-        localFingerprints.append(settings->value(localFingerprintKey, 0).toLongLong());
+    //Syncs are stored in groups named with their ID. Configs written by
+    //previous versions don't have the list of IDs, their groups are 0..n-1
+    QStringList syncIds = settings->value(syncIdsKey).toString().split(QString::fromAscii(","), QString::SkipEmptyParts);
+    bool legacyFormat = syncIds.isEmpty();
+    if (legacyFormat)
+    {
+        int numSyncs = settings->numChildGroups();
+        for (int i = 0; i < numSyncs; i++)
+        {
+            syncIds.append(QString::number(i));
+        }
+    }
 
+    for (int i = 0; i < syncIds.size(); i++)
+    {
+        SyncConfig syncConfig;
+        syncConfig.id = syncIds.at(i).toInt();
+
+        settings->beginGroup(syncIds.at(i));
+        syncConfig.name = settings->value(syncNameKey).toString();
+        syncConfig.localFolder = settings->value(localFolderKey).toString();
+        syncConfig.megaFolder = settings->value(megaFolderKey).toString();
+        syncConfig.megaFolderHandle = settings->value(megaFolderHandleKey).toLongLong();
+        syncConfig.active = settings->value(folderActiveKey, true).toBool();
+        syncConfig.temporaryInactive = settings->value(temporaryInactiveKey, false).toBool();
+        syncConfig.localFingerprint = settings->value(localFingerprintKey, 0).toLongLong();
         settings->endGroup();
+
+        syncConfigs.append(syncConfig);
+        nextSyncId = qMax(nextSyncId, syncConfig.id + 1);
     }
     settings->endGroup();
+
+    if (legacyFormat && syncConfigs.size())
+    {
+        writeSyncIds();
+    }
+    updateSyncIndexes();
     mutex.unlock();
 }
 
-void Preferences::writeFolders()
+//Writes the values of a sync, the caller is responsible for the sync of the settings
+void Preferences::writeSyncConfig(const SyncConfig &syncConfig)
 {
     mutex.lock();
     assert(logged());
 
     settings->beginGroup(syncsGroupKey);
+    settings->beginGroup(QString::number(syncConfig.id));
+    settings->setValue(syncNameKey, syncConfig.name);
+    settings->setValue(localFolderKey, syncConfig.localFolder);
+    settings->setValue(megaFolderKey, syncConfig.megaFolder);
+    settings->setValue(megaFolderHandleKey, syncConfig.megaFolderHandle);
+    settings->setValue(folderActiveKey, syncConfig.active);
+    settings->setValue(temporaryInactiveKey, syncConfig.temporaryInactive);
+    settings->setValue(localFingerprintKey, syncConfig.localFingerprint);
+    settings->endGroup();
+    settings->endGroup();
+    mutex.unlock();
+}
 
-    settings->remove(QString::fromAscii(""));
-    for (int i = 0; i < localFolders.size(); i++)
-    {
-        settings->beginGroup(QString::number(i));
-
-        settings->setValue(syncNameKey, syncNames[i]);
-        settings->setValue(localFolderKey, localFolders[i]);
-        settings->setValue(megaFolderKey, megaFolders[i]);
-        settings->setValue(megaFolderHandleKey, megaFolderHandles[i]);
-        settings->setValue(folderActiveKey, activeFolders[i]);
-        settings->setValue(temporaryInactiveKey,temporaryInactiveFolders[i]);
-        settings->setValue(localFingerprintKey, localFingerprints[i]);
+//Writes the IDs of the syncs in order, the caller is responsible for the sync of the settings
+void Preferences::writeSyncIds()
+{
+    mutex.lock();
+    assert(logged());
 
-        settings->endGroup();
+    QStringList syncIds;
+    for (int i = 0; i < syncConfigs.size(); i++)
+    {
+        syncIds.append(QString::number(syncConfigs.at(i).id));
     }
 
+    settings->beginGroup(syncsGroupKey);
+    settings->setValue(syncIdsKey, syncIds.join(QString::fromAscii(",")));
     settings->endGroup();
-    settings->sync();
     mutex.unlock();
 }
+
+void Preferences::clearSyncs()
+{
+    mutex.lock();
+    syncConfigs.clear();
+    syncIndexesById.clear();
+    syncIndexesByHandle.clear();
+    syncIndexesByLocalPath.clear();
+    activeSyncRoots.clear();
+    nextSyncId = 0;
+    mutex.unlock();
+}
+
+void Preferences::updateSyncIndexes()
+{
+    mutex.lock();
+    syncIndexesById.clear();
+    syncIndexesByHandle.clear();
+    syncIndexesByLocalPath.clear();
+    activeSyncRoots.clear();
+    for (int i = 0; i < syncConfigs.size(); i++)
+    {
+        const SyncConfig &syncConfig = syncConfigs.at(i);
+        syncIndexesById.insert(syncConfig.id, i);
+        syncIndexesByHandle.insert(syncConfig.megaFolderHandle, i);
+        syncIndexesByLocalPath.insert(syncPathKey(syncConfig.localFolder), i);
+        if (syncConfig.active)
+        {
+            activeSyncRoots.insert(syncConfig.megaFolderHandle, i);
+        }
+    }
+    mutex.unlock();
+}
+
+QString Preferences::syncPathKey(QString localPath)
+{
+    QString path = QDir::toNativeSeparators(QDir::cleanPath(localPath));
+#ifdef WIN32
+    //Paths are case insensitive on Windows, so lookups by local path are too
+    path = path.toLower();
+#endif
+    return path;
+}
@@ -6,12 +6,28 @@
 #include <QLocale>
 #include <QStringList>
 #include <QMutex>
+#include <QHash>
+#include <QTimer>
 
 #include "control/EncryptedSettings.h"
 #include "megaapi.h"
 
 Q_DECLARE_METATYPE(QList<long long>)
 
+class SyncConfig
+{
+public:
+    //Stable identifier, it doesn't change when other syncs are removed
+    int id;
+    QString name;
+    QString localFolder;
+    QString megaFolder;
+    mega::MegaHandle megaFolderHandle;
+    long long localFingerprint;
+    bool active;
+    bool temporaryInactive;
+};
+
 class Preferences : public QObject
 {
     Q_OBJECT
@@ -102,6 +118,15 @@ public:
     bool canUpdate(QString filePath);
     int uploadLimitKB();
     void setUploadLimitKB(int value);
+    int maxConcurrentSyncResumes();
+    void setMaxConcurrentSyncResumes(int value);
+    int debrisMaxAgeDays();
+    void setDebrisMaxAgeDays(int value);
+    //Not shown in the settings, only the age limit can be enabled there
+    long long debrisMaxSizeMB();
+    void setDebrisMaxSizeMB(long long value);
+    bool allowHardLinksInSyncs();
+    void setAllowHardLinksInSyncs(bool value);
     long long upperSizeLimitValue();
     void setUpperSizeLimitValue(long long value);
     long long lowerSizeLimitValue();
@@ -184,6 +209,13 @@ public:
     QStringList getMegaFolders();
     QStringList getLocalFolders();
     QList<long long> getMegaFolderHandles();
+    QHash<mega::MegaHandle, int> getActiveSyncRoots();
+    //Stable ID of the sync in the position num, -1 if it doesn't exist
+    int getSyncId(int num);
+    //Index of a sync, -1 if it doesn't exist
+    int getSyncIndexById(int syncId);
+    int getSyncIndexByHandle(mega::MegaHandle handle);
+    int getSyncIndexByLocalPath(QString localPath);
 
     void addSyncedFolder(QString localFolder, QString megaFolder, mega::MegaHandle megaFolderHandle, QString syncName = QString(), bool active = true);
     void setMegaFolderHandle(int num, mega::MegaHandle handle);
@@ -207,6 +239,9 @@ public:
 
     bool isCrashed();
     void setCrashed(bool value);
+    //Explicit request to reload the filesystem in the next execution
+    bool needsFullReload();
+    void setNeedsFullReload(bool value);
     bool wasPaused();
     void setWasPaused(bool value);
 
@@ -218,6 +253,7 @@ public:
     bool error();
 
     void clearAll();
+    //Writes the pending changes to disk immediately
     void sync();
 
     enum {
@@ -265,6 +301,25 @@ public:
     static const char UPDATE_PUBLIC_KEY[];
     static const long long MIN_REBOOT_INTERVAL_MS;
     static const long long MIN_EXTERNAL_NODES_WARNING_MS;
+    static const int MAX_EXPORT_REQUESTS_IN_FLIGHT;
+    static const int MAX_LINK_INFO_REQUESTS_IN_FLIGHT;
+    static const int PUBLIC_NODE_CACHE_SIZE;
+    static const long long PUBLIC_NODE_CACHE_TTL_MS;
+    static const int TRANSFER_STATS_PUBLISH_INTERVAL_MS;
+    static const int LARGE_NODE_UPDATE_BATCH;
+    static const int MAX_RECENT_FILES_PER_NODE_UPDATE;
+    static const int SETTINGS_SYNC_DELAY_MS;
+    static const int SYNC_RESCAN_MAX_ENTRIES_PER_SECOND;
+    static const int SYNC_RESCAN_PROGRESS_INTERVAL_MS;
+    static const int DEBRIS_RETENTION_INTERVAL_MS;
+    //Maximum age of the local debris when the retention policy is enabled in the settings
+    static const int DEBRIS_RETENTION_DAYS;
+    static const int LOCAL_COPY_PROGRESS_INTERVAL_MS;
+    static const int SYNC_SIZE_REPORT_MAX_FOLDERS;
+    static const int SYNC_RESUME_SCAN_TIMEOUT_MS;
+    static const int NODE_MODEL_PAGE_SIZE;
+    //Storage of MEGAsync.cfg (EncryptedSettings::FORMAT_INI or FORMAT_BLOB)
+    static const int SETTINGS_FORMAT;
     static const char CLIENT_KEY[];
     static const char USER_AGENT[];
     static const int VERSION_CODE;
@@ -279,28 +334,40 @@ public:
     static const QString HTTPS_CERT;
     static QStringList HTTPS_ALLOWED_ORIGINS;
 
+protected slots:
+    void syncPendingChanges();
+
 protected:
     QMutex mutex;
+    //Schedules a write of the settings file.
+    //Changes made within SETTINGS_SYNC_DELAY_MS are written together
+    void requestSync();
+    QTimer *syncTimer;
+    bool pendingSync;
     void login(QString account);
     void logout();
 
     void loadExcludedSyncNames();
     void readFolders();
-    void writeFolders();
+    void writeSyncConfig(const SyncConfig &syncConfig);
+    void writeSyncIds();
+    void clearSyncs();
+    void updateSyncIndexes();
+    static QString syncPathKey(QString localPath);
 
     EncryptedSettings *settings;
-    QStringList syncNames;
-    QStringList megaFolders;
-    QStringList localFolders;
-    QList<long long> megaFolderHandles;
-    QList<long long> localFingerprints;
-    QList<bool> activeFolders;
-    QList<bool> temporaryInactiveFolders;
+    QList<SyncConfig> syncConfigs;
+    QHash<int, int> syncIndexesById;
+    QHash<mega::MegaHandle, int> syncIndexesByHandle;
+    QHash<QString, int> syncIndexesByLocalPath;
+    int nextSyncId;
+    QHash<mega::MegaHandle, int> activeSyncRoots;
     QStringList excludedSyncNames;
     bool errorFlag;
 
     static const QString currentAccountKey;
     static const QString syncsGroupKey;
+    static const QString syncIdsKey;
     static const QString emailKey;
     static const QString emailHashKey;
     static const QString privatePwKey;
@@ -329,6 +396,10 @@ protected:
     static const QString languageKey;
     static const QString updateAutomaticallyKey;
     static const QString uploadLimitKBKey;
+    static const QString maxConcurrentSyncResumesKey;
+    static const QString debrisMaxAgeDaysKey;
+    static const QString debrisMaxSizeMBKey;
+    static const QString allowHardLinksInSyncsKey;
     static const QString upperSizeLimitKey;
     static const QString lowerSizeLimitKey;
     static const QString upperSizeLimitValueKey;
@@ -365,6 +436,7 @@ protected:
     static const QString excludedSyncNamesKey;
     static const QString lastVersionKey;
     static const QString isCrashedKey;
+    static const QString needsFullReloadKey;
     static const QString lastStatsRequestKey;
     static const QString wasPausedKey;
     static const QString lastUpdateTimeKey;
@@ -391,6 +463,10 @@ protected:
     static const bool defaultStartOnStartup;
     static const bool defaultUpdateAutomatically;
     static const int  defaultUploadLimitKB;
+    static const int  defaultMaxConcurrentSyncResumes;
+    static const int  defaultDebrisMaxAgeDays;
+    static const long long defaultDebrisMaxSizeMB;
+    static const bool defaultAllowHardLinksInSyncs;
     static const int  defaultProxyType;
     static const int  defaultProxyProtocol;
     static const QString  defaultProxyServer;
@@ -0,0 +1,51 @@
+#include "PublicNodeCache.h"
+#include "Preferences.h"
+#include <QDateTime>
+
+using namespace mega;
+
+PublicNodeCache *PublicNodeCache::instance()
+{
+    static PublicNodeCache globalCache;
+    return &globalCache;
+}
+
+PublicNodeCache::PublicNodeCache()
+{
+    nodes.setMaxCost(Preferences::PUBLIC_NODE_CACHE_SIZE);
+}
+
+MegaNode *PublicNodeCache::getNode(QString link)
+{
+    QMutexLocker locker(&mutex);
+    CachedPublicNode *cached = nodes.object(link);
+    if (!cached)
+    {
+        return NULL;
+    }
+
+    if ((QDateTime::currentMSecsSinceEpoch() - cached->timestamp) > Preferences::PUBLIC_NODE_CACHE_TTL_MS)
+    {
+        nodes.remove(link);
+        return NULL;
+    }
+
+    return cached->node->copy();
+}
+
+void PublicNodeCache::addNode(QString link, MegaNode *node)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    nodes.insert(link, new CachedPublicNode(node->copy(), QDateTime::currentMSecsSinceEpoch()));
+}
+
+void PublicNodeCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    nodes.clear();
+}
@@ -0,0 +1,38 @@
+#ifndef PUBLICNODECACHE_H
+#define PUBLICNODECACHE_H
+
+#include <QString>
+#include <QCache>
+#include <QMutex>
+#include "megaapi.h"
+
+class CachedPublicNode
+{
+public:
+    CachedPublicNode(mega::MegaNode *node, long long timestamp) : node(node), timestamp(timestamp) {}
+    ~CachedPublicNode() { delete node; }
+
+    mega::MegaNode *node;
+    long long timestamp;
+};
+
+//In-memory LRU cache of public link -> public node metadata with a time to live.
+//Shared by everything that resolves public links (link import, streaming, web downloads)
+class PublicNodeCache
+{
+public:
+    static PublicNodeCache *instance();
+
+    //Returns a copy of the cached node (owned by the caller) or NULL
+    mega::MegaNode *getNode(QString link);
+    void addNode(QString link, mega::MegaNode *node);
+    void clear();
+
+protected:
+    PublicNodeCache();
+
+    QMutex mutex;
+    QCache<QString, CachedPublicNode> nodes;
+};
+
+#endif // PUBLICNODECACHE_H
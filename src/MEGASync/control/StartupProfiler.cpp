@@ -0,0 +1,165 @@
+#include "StartupProfiler.h"
+#include "megaapi.h"
+#include <QFile>
+#include <QThread>
+#include <QTextStream>
+
+using namespace mega;
+
+const char *StartupProfiler::TRACE_ENV_VAR = "MEGASYNC_STARTUP_TRACE";
+
+StartupProfiler *StartupProfiler::instance()
+{
+    static StartupProfiler profiler;
+    return &profiler;
+}
+
+StartupProfiler::StartupProfiler()
+{
+    finished = false;
+    timer.start();
+}
+
+void StartupProfiler::begin(const QString &phase)
+{
+    StartupEvent event;
+    event.name = phase;
+    event.type = 'X';
+    event.timestamp = now();
+    event.duration = 0;
+    event.threadId = (quint64)(quintptr)QThread::currentThreadId();
+
+    QMutexLocker locker(&mutex);
+    if (!finished)
+    {
+        openPhases.insert(phase, event);
+    }
+}
+
+void StartupProfiler::end(const QString &phase)
+{
+    qint64 timestamp = now();
+
+    QMutexLocker locker(&mutex);
+    QHash<QString, StartupEvent>::iterator it = openPhases.find(phase);
+    if (it == openPhases.end())
+    {
+        return;
+    }
+
+    StartupEvent event = it.value();
+    openPhases.erase(it);
+    event.duration = timestamp - event.timestamp;
+    events.append(event);
+}
+
+void StartupProfiler::mark(const QString &name)
+{
+    StartupEvent event;
+    event.name = name;
+    event.type = 'i';
+    event.timestamp = now();
+    event.duration = 0;
+    event.threadId = (quint64)(quintptr)QThread::currentThreadId();
+
+    QMutexLocker locker(&mutex);
+    if (!finished)
+    {
+        events.append(event);
+    }
+}
+
+void StartupProfiler::finish()
+{
+    QMutexLocker locker(&mutex);
+    if (finished)
+    {
+        return;
+    }
+    finished = true;
+    openPhases.clear();
+
+    QString phases;
+    QString marks;
+    for (int i = 0; i < events.size(); i++)
+    {
+        const StartupEvent &event = events.at(i);
+        if (event.type == 'X')
+        {
+            phases.append(QString::fromUtf8(" %1=%2ms").arg(event.name).arg(event.duration / 1000));
+        }
+        else
+        {
+            marks.append(QString::fromUtf8(" %1@%2ms").arg(event.name).arg(event.timestamp / 1000));
+        }
+    }
+    MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Startup profile:%1 |%2")
+                 .arg(phases).arg(marks).toUtf8().constData());
+
+    QByteArray tracePath = qgetenv(TRACE_ENV_VAR);
+    if (tracePath.size())
+    {
+        writeTrace(tracePath == "1" ? QString::fromUtf8("megasync_startup_trace.json")
+                                    : QString::fromLocal8Bit(tracePath));
+    }
+}
+
+bool StartupProfiler::isFinished()
+{
+    QMutexLocker locker(&mutex);
+    return finished;
+}
+
+//Microseconds since the start of the process
+qint64 StartupProfiler::now()
+{
+    return timer.nsecsElapsed() / 1000;
+}
+
+void StartupProfiler::writeTrace(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Unable to write the startup trace to %1")
+                     .arg(path).toUtf8().constData());
+        return;
+    }
+
+    QTextStream stream(&file);
+    stream << "{\"traceEvents\":[";
+    for (int i = 0; i < events.size(); i++)
+    {
+        const StartupEvent &event = events.at(i);
+        if (i)
+        {
+            stream << ",";
+        }
+
+        stream << "\n{\"name\":\"" << QString(event.name).replace(QChar::fromAscii('"'), QString::fromAscii("\\\""))
+               << "\",\"cat\":\"startup\",\"ph\":\"" << QChar::fromAscii(event.type)
+               << "\",\"ts\":" << event.timestamp
+               << ",\"pid\":1,\"tid\":" << event.threadId;
+        if (event.type == 'X')
+        {
+            stream << ",\"dur\":" << event.duration;
+        }
+        else
+        {
+            stream << ",\"s\":\"g\"";
+        }
+        stream << "}";
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+StartupPhase::StartupPhase(const char *phase)
+{
+    this->phase = QString::fromUtf8(phase);
+    StartupProfiler::instance()->begin(this->phase);
+}
+
+StartupPhase::~StartupPhase()
+{
+    StartupProfiler::instance()->end(phase);
+}
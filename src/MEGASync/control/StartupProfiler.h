@@ -0,0 +1,62 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+
+class StartupEvent
+{
+public:
+    QString name;
+    //'X' for phases, 'i' for instant events (Chrome trace_event types)
+    char type;
+    qint64 timestamp;
+    qint64 duration;
+    quint64 threadId;
+};
+
+//Timing of the startup phases (time-to-tray, time-to-synced...).
+//A one-line summary is logged when the startup finishes and, if the
+//MEGASYNC_STARTUP_TRACE environment variable is set, the events are
+//saved in the Chrome trace_event format (chrome://tracing) to the file
+//in the variable ("1" uses megasync_startup_trace.json in the current folder)
+class StartupProfiler
+{
+public:
+    static StartupProfiler *instance();
+
+    void begin(const QString &phase);
+    void end(const QString &phase);
+    void mark(const QString &event);
+    void finish();
+    bool isFinished();
+
+    static const char *TRACE_ENV_VAR;
+
+protected:
+    StartupProfiler();
+    qint64 now();
+    void writeTrace(const QString &path);
+
+    QMutex mutex;
+    QElapsedTimer timer;
+    QHash<QString, StartupEvent> openPhases;
+    QList<StartupEvent> events;
+    bool finished;
+};
+
+//Scoped phase, measured from the constructor to the destructor
+class StartupPhase
+{
+public:
+    explicit StartupPhase(const char *phase);
+    ~StartupPhase();
+
+protected:
+    QString phase;
+};
+
+#endif // STARTUPPROFILER_H
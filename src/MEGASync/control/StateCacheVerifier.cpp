@@ -0,0 +1,172 @@
+#include "StateCacheVerifier.h"
+#include "megaapi.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+
+#ifdef USE_SQLITE
+#include <sqlite3.h>
+#endif
+
+using namespace mega;
+
+int StateCacheVerifier::verifyCaches(const QString &dataPath)
+{
+    QDir dataDir(dataPath);
+    QStringList databases = dataDir.entryList(QStringList() << QString::fromAscii("*.db"), QDir::Files);
+    int removed = 0;
+
+    for (int i = 0; i < databases.size(); i++)
+    {
+        QString dbPath = dataDir.filePath(databases[i]);
+        QString reason;
+        if (checkDatabase(dbPath, &reason))
+        {
+            MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Keeping local cache %1: %2")
+                         .arg(databases[i]).arg(reason).toUtf8().constData());
+        }
+        else
+        {
+            MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Removing local cache %1: %2")
+                         .arg(databases[i]).arg(reason).toUtf8().constData());
+            removeDatabase(dbPath);
+            removed++;
+        }
+    }
+
+    //Journals without a database can't be used
+    QStringList journals = dataDir.entryList(QStringList() << QString::fromAscii("*.db-wal")
+                                             << QString::fromAscii("*.db-shm"), QDir::Files);
+    for (int i = 0; i < journals.size(); i++)
+    {
+        QString dbName = journals[i].left(journals[i].lastIndexOf(QChar::fromAscii('-')));
+        if (!databases.contains(dbName))
+        {
+            MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Removing orphan journal %1")
+                         .arg(journals[i]).toUtf8().constData());
+            QFile::remove(dataDir.filePath(journals[i]));
+        }
+    }
+
+    return removed;
+}
+
+void StateCacheVerifier::removeCaches(const QString &dataPath)
+{
+    MegaApi::log(MegaApi::LOG_LEVEL_INFO, "Removing all the local caches to reload the filesystem");
+    QDir dataDir(dataPath);
+    QStringList files = dataDir.entryList(QStringList() << QString::fromAscii("*.db")
+                                          << QString::fromAscii("*.db-wal")
+                                          << QString::fromAscii("*.db-shm"), QDir::Files);
+    for (int i = 0; i < files.size(); i++)
+    {
+        QFile::remove(dataDir.filePath(files[i]));
+    }
+}
+
+#ifdef USE_SQLITE
+static bool queryInteger(sqlite3 *db, const char *sql, long long *result)
+{
+    sqlite3_stmt *stmt = NULL;
+    bool success = false;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK
+            && sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        *result = sqlite3_column_int64(stmt, 0);
+        success = true;
+    }
+    sqlite3_finalize(stmt);
+    return success;
+}
+#endif
+
+bool StateCacheVerifier::checkDatabase(const QString &dbPath, QString *reason)
+{
+#ifdef USE_SQLITE
+    //Opening the database in read-write mode replays its WAL journal
+    sqlite3 *db = NULL;
+    if (sqlite3_open_v2(dbPath.toUtf8().constData(), &db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK)
+    {
+        *reason = QString::fromUtf8("unable to open it (%1)").arg(QString::fromUtf8(sqlite3_errmsg(db)));
+        sqlite3_close(db);
+        return false;
+    }
+
+    //quick_check verifies the structure of the pages and the records
+    //without the O(N log N) index cross-check of integrity_check
+    sqlite3_stmt *stmt = NULL;
+    QStringList errors;
+    if (sqlite3_prepare_v2(db, "PRAGMA quick_check", -1, &stmt, NULL) != SQLITE_OK)
+    {
+        errors.append(QString::fromUtf8(sqlite3_errmsg(db)));
+    }
+    else
+    {
+        int result;
+        while ((result = sqlite3_step(stmt)) == SQLITE_ROW)
+        {
+            QString row = QString::fromUtf8((const char *)sqlite3_column_text(stmt, 0));
+            if (row != QString::fromAscii("ok"))
+            {
+                errors.append(row);
+            }
+        }
+
+        if (result != SQLITE_DONE)
+        {
+            errors.append(QString::fromUtf8(sqlite3_errmsg(db)));
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    if (errors.size())
+    {
+        *reason = QString::fromUtf8("quick check failed (%1)").arg(errors.join(QString::fromAscii("; ")));
+        sqlite3_close(db);
+        return false;
+    }
+
+    //Consistency probe: the SDK keeps every record in the "statecache" table
+    //and never stores empty records
+    long long numTables = 0;
+    long long numRecords = 0;
+    long long emptyRecords = 0;
+    if (!queryInteger(db, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = 'statecache'", &numTables)
+            || !numTables)
+    {
+        *reason = QString::fromUtf8("the state cache table is missing");
+        sqlite3_close(db);
+        return false;
+    }
+
+    if (!queryInteger(db, "SELECT COUNT(*) FROM statecache", &numRecords)
+            || !queryInteger(db, "SELECT COUNT(*) FROM statecache WHERE content IS NULL OR LENGTH(content) = 0", &emptyRecords))
+    {
+        *reason = QString::fromUtf8("unable to read the state cache (%1)").arg(QString::fromUtf8(sqlite3_errmsg(db)));
+        sqlite3_close(db);
+        return false;
+    }
+
+    sqlite3_close(db);
+    if (emptyRecords)
+    {
+        *reason = QString::fromUtf8("%1 of %2 records are empty").arg(emptyRecords).arg(numRecords);
+        return false;
+    }
+
+    *reason = QString::fromUtf8("quick check passed, %1 records").arg(numRecords);
+    return true;
+#else
+    Q_UNUSED(dbPath);
+    *reason = QString::fromUtf8("SQLite isn't available to verify it");
+    return false;
+#endif
+}
+
+void StateCacheVerifier::removeDatabase(const QString &dbPath)
+{
+    QFile::remove(dbPath);
+    QFile::remove(dbPath + QString::fromAscii("-wal"));
+    QFile::remove(dbPath + QString::fromAscii("-shm"));
+}
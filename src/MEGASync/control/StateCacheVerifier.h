@@ -0,0 +1,23 @@
+#ifndef STATECACHEVERIFIER_H
+#define STATECACHEVERIFIER_H
+
+#include <QString>
+
+//Checks the local caches of the SDK (*.db files in the data folder)
+//after an unclean shutdown. Only the databases that fail the SQLite
+//quick check or the consistency probe are removed, so the rest of them
+//don't force a full fetchnodes and a full rescan of the syncs
+class StateCacheVerifier
+{
+public:
+    //Returns the number of removed databases
+    static int verifyCaches(const QString &dataPath);
+    //Removes all the databases and journals, to reload the filesystem
+    static void removeCaches(const QString &dataPath);
+
+protected:
+    static bool checkDatabase(const QString &dbPath, QString *reason);
+    static void removeDatabase(const QString &dbPath);
+};
+
+#endif // STATECACHEVERIFIER_H
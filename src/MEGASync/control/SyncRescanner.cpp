@@ -0,0 +1,132 @@
+#include "SyncRescanner.h"
+#include "Preferences.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QStack>
+
+using namespace mega;
+using namespace std;
+
+SyncRescanner::SyncRescanner(MegaApi *megaApi, int syncId, QString localFolder, QObject *parent)
+    : QThread(parent)
+{
+    this->megaApi = megaApi;
+    this->syncId = syncId;
+    this->localFolder = localFolder;
+    this->startTime = 0;
+    this->lastProgressTime = 0;
+    this->numFolders = 0;
+    this->numFiles = 0;
+    this->numMismatches = 0;
+}
+
+int SyncRescanner::getSyncId()
+{
+    return syncId;
+}
+
+void SyncRescanner::cancel()
+{
+    cancelled = 1;
+}
+
+void SyncRescanner::run()
+{
+    MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Rescanning sync %1: %2")
+                 .arg(syncId).arg(localFolder).toUtf8().constData());
+
+    timer.start();
+    startTime = QDateTime::currentMSecsSinceEpoch() / 1000;
+    QString debrisName = QString::fromAscii(MEGA_DEBRIS_FOLDER);
+
+    //Iterative walk, deep trees don't grow the stack of the thread
+    QStack<QString> pendingFolders;
+    pendingFolders.push(localFolder);
+    while (!pendingFolders.isEmpty() && !cancelled)
+    {
+        QString folderPath = pendingFolders.pop();
+        QFileInfoList entries = QDir(folderPath).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot
+                                                               | QDir::Hidden | QDir::System);
+        numFolders++;
+
+        for (int i = 0; i < entries.size() && !cancelled; i++)
+        {
+            const QFileInfo &entry = entries[i];
+            if (entry.isSymLink())
+            {
+                continue;
+            }
+
+            if (entry.isDir())
+            {
+                if (folderPath == localFolder && entry.fileName() == debrisName)
+                {
+                    continue;
+                }
+                pendingFolders.push(entry.absoluteFilePath());
+            }
+            else
+            {
+                numFiles++;
+            }
+
+            //Entries created or modified during the rescan
+            //can be still unknown to the sync engine
+            if (entry.lastModified().toMSecsSinceEpoch() / 1000 < startTime
+                    && !isKnownBySync(QDir::toNativeSeparators(entry.absoluteFilePath())))
+            {
+                numMismatches++;
+                MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, QString::fromUtf8("Entry not found in the sync: %1")
+                             .arg(entry.absoluteFilePath()).toUtf8().constData());
+            }
+
+            throttle();
+        }
+        reportProgress(false);
+    }
+
+    reportProgress(true);
+    MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Rescan of sync %1 %2: %3 folders, %4 files, %5 mismatches in %6 ms")
+                 .arg(syncId).arg(cancelled ? QString::fromUtf8("cancelled") : QString::fromUtf8("finished"))
+                 .arg(numFolders).arg(numFiles).arg(numMismatches).arg(timer.elapsed()).toUtf8().constData());
+    emit rescanFinished(syncId, numFolders, numFiles, numMismatches, cancelled);
+}
+
+bool SyncRescanner::isKnownBySync(const QString &path)
+{
+#ifdef WIN32
+    string localPath((const char*)path.utf16(), path.size() * sizeof(wchar_t));
+#else
+    string localPath(path.toUtf8().constData());
+#endif
+
+    //Excluded entries are reported as ignored
+    return megaApi->syncPathState(&localPath) != MegaApi::STATE_NONE;
+}
+
+void SyncRescanner::throttle()
+{
+    long long numEntries = numFolders + numFiles;
+    long long expectedTime = numEntries * 1000 / Preferences::SYNC_RESCAN_MAX_ENTRIES_PER_SECOND;
+    long long elapsed = timer.elapsed();
+    if (elapsed < expectedTime)
+    {
+        msleep(expectedTime - elapsed);
+    }
+}
+
+void SyncRescanner::reportProgress(bool force)
+{
+    long long elapsed = timer.elapsed();
+    if (!force && (elapsed - lastProgressTime) < Preferences::SYNC_RESCAN_PROGRESS_INTERVAL_MS)
+    {
+        return;
+    }
+
+    lastProgressTime = elapsed;
+    long long elapsedMs = qMax(elapsed, 1LL);
+    emit rescanProgress(syncId, numFolders, numFiles,
+                        (int)(numFolders * 1000 / elapsedMs),
+                        (int)(numFiles * 1000 / elapsedMs));
+}
@@ -0,0 +1,49 @@
+#ifndef SYNCRESCANNER_H
+#define SYNCRESCANNER_H
+
+#include <QThread>
+#include <QString>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <megaapi.h>
+
+//Verifies one synced folder while the rest of the syncs keep running.
+//The local folder is walked at a limited rate (SYNC_RESCAN_MAX_ENTRIES_PER_SECOND)
+//and every entry is checked against the state of the sync engine.
+//Entries unknown to the engine are reported as mismatches, so the caller
+//can decide whether the sync has to be repaired
+class SyncRescanner : public QThread
+{
+    Q_OBJECT
+
+public:
+    SyncRescanner(mega::MegaApi *megaApi, int syncId, QString localFolder, QObject *parent = 0);
+    int getSyncId();
+    void cancel();
+
+signals:
+    void rescanProgress(int syncId, long long numFolders, long long numFiles,
+                        int foldersPerSecond, int filesPerSecond);
+    void rescanFinished(int syncId, long long numFolders, long long numFiles,
+                        long long numMismatches, bool cancelled);
+
+protected:
+    virtual void run();
+    bool isKnownBySync(const QString &path);
+    void throttle();
+    void reportProgress(bool force);
+
+    mega::MegaApi *megaApi;
+    int syncId;
+    QString localFolder;
+    QAtomicInt cancelled;
+
+    QElapsedTimer timer;
+    long long startTime;
+    long long lastProgressTime;
+    long long numFolders;
+    long long numFiles;
+    long long numMismatches;
+};
+
+#endif // SYNCRESCANNER_H
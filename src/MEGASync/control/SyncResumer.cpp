@@ -0,0 +1,252 @@
+#include "SyncResumer.h"
+#include "Preferences.h"
+#include "StartupProfiler.h"
+#include <QtCore>
+
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrent>
+#endif
+
+using namespace mega;
+
+SyncResumer::SyncResumer(MegaApi *megaApi, QObject *parent) : QObject(parent)
+{
+    this->megaApi = megaApi;
+    this->resuming = false;
+    delegateListener = new QTMegaRequestListener(megaApi, this);
+    connect(&cleanupWatcher, SIGNAL(finished()), this, SLOT(onCleanupFinished()));
+    scanTimer.setSingleShot(true);
+    connect(&scanTimer, SIGNAL(timeout()), this, SLOT(onScanTimeout()));
+}
+
+SyncResumer::~SyncResumer()
+{
+    cleanupWatcher.waitForFinished();
+    delete delegateListener;
+}
+
+bool SyncResumer::isResuming()
+{
+    return resuming;
+}
+
+void SyncResumer::resumeSyncs()
+{
+    Preferences *preferences = Preferences::instance();
+    if (resuming || !preferences->logged())
+    {
+        return;
+    }
+
+    resuming = true;
+    StartupProfiler::instance()->begin(QString::fromUtf8("resumeSyncs"));
+
+    cleanupFolders.clear();
+    pendingSyncIds.clear();
+    repairedSyncIds.clear();
+    for (int i = 0; i < preferences->getNumSyncedFolders(); i++)
+    {
+        cleanupFolders.append(preferences->getLocalFolder(i));
+        if (preferences->isFolderActive(i))
+        {
+            pendingSyncIds.enqueue(preferences->getSyncId(i));
+        }
+    }
+
+    cleanupWatcher.setFuture(QtConcurrent::map(cleanupFolders, SyncResumer::removeTemporaryFiles));
+}
+
+void SyncResumer::onCleanupFinished()
+{
+    MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Temporary files of %1 syncs removed, resuming %2 syncs")
+                 .arg(cleanupFolders.size()).arg(pendingSyncIds.size()).toUtf8().constData());
+    cleanupFolders.clear();
+    resumeNextSyncs();
+}
+
+void SyncResumer::repairSyncs(QList<int> syncIds)
+{
+    Preferences *preferences = Preferences::instance();
+    for (int i = 0; i < syncIds.size(); i++)
+    {
+        int syncId = syncIds[i];
+        int index = preferences->getSyncIndexById(syncId);
+        if (index < 0 || !preferences->isFolderActive(index)
+                || repairedSyncIds.contains(syncId)
+                || removingSyncIds.values().contains(syncId))
+        {
+            continue;
+        }
+
+        MegaNode *node = megaApi->getNodeByHandle(preferences->getMegaFolderHandle(index));
+        if (!node)
+        {
+            continue;
+        }
+
+        MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Repairing sync %1: %2")
+                     .arg(syncId).arg(preferences->getLocalFolder(index)).toUtf8().constData());
+        removingSyncIds.insert(node->getHandle(), syncId);
+        megaApi->removeSync(node, delegateListener);
+        delete node;
+    }
+}
+
+void SyncResumer::onRequestFinish(MegaApi *, MegaRequest *request, MegaError *e)
+{
+    if (request->getType() != MegaRequest::TYPE_REMOVE_SYNC
+            || !removingSyncIds.contains(request->getNodeHandle()))
+    {
+        return;
+    }
+
+    int syncId = removingSyncIds.take(request->getNodeHandle());
+    if (e->getErrorCode() != MegaError::API_OK)
+    {
+        MegaApi::log(MegaApi::LOG_LEVEL_ERROR, QString::fromUtf8("Unable to remove sync %1 to repair it: %2")
+                     .arg(syncId).arg(QString::fromUtf8(e->getErrorString())).toUtf8().constData());
+        return;
+    }
+
+    //The sync is added again only when the engine has released it
+    repairedSyncIds.insert(syncId);
+    pendingSyncIds.enqueue(syncId);
+    if (!cleanupWatcher.isRunning())
+    {
+        resumeNextSyncs();
+    }
+}
+
+void SyncResumer::onSyncAdded(MegaHandle handle, int errorCode)
+{
+    //A sync that couldn't be added won't scan
+    if (errorCode != MegaError::API_OK)
+    {
+        releaseSlot(handle);
+    }
+}
+
+void SyncResumer::onSyncStateChanged(MegaHandle handle, int state)
+{
+    if (state != MegaSync::SYNC_INITIALSCAN)
+    {
+        releaseSlot(handle);
+    }
+}
+
+void SyncResumer::onScanTimeout()
+{
+    //Syncs that take too long to scan don't block the rest
+    long long now = QDateTime::currentMSecsSinceEpoch();
+    QList<MegaHandle> expiredHandles;
+    QHash<MegaHandle, long long>::const_iterator it;
+    for (it = resumingHandles.constBegin(); it != resumingHandles.constEnd(); ++it)
+    {
+        if ((now - it.value()) >= Preferences::SYNC_RESUME_SCAN_TIMEOUT_MS)
+        {
+            expiredHandles.append(it.key());
+        }
+    }
+
+    for (int i = 0; i < expiredHandles.size(); i++)
+    {
+        int index = Preferences::instance()->getSyncIndexByHandle(expiredHandles[i]);
+        MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Initial scan of %1 still running, resuming the next sync")
+                     .arg(index >= 0 ? Preferences::instance()->getLocalFolder(index) : QString()).toUtf8().constData());
+        resumingHandles.remove(expiredHandles[i]);
+    }
+    resumeNextSyncs();
+}
+
+void SyncResumer::releaseSlot(MegaHandle handle)
+{
+    if (resumingHandles.remove(handle))
+    {
+        resumeNextSyncs();
+    }
+}
+
+void SyncResumer::resumeNextSyncs()
+{
+    Preferences *preferences = Preferences::instance();
+    if (!preferences->logged())
+    {
+        pendingSyncIds.clear();
+        resumingHandles.clear();
+        repairedSyncIds.clear();
+    }
+
+    int maxResumes = preferences->logged() ? preferences->maxConcurrentSyncResumes() : 0;
+    while (!pendingSyncIds.isEmpty() && resumingHandles.size() < maxResumes)
+    {
+        int syncId = pendingSyncIds.dequeue();
+        bool repaired = repairedSyncIds.remove(syncId);
+        int index = preferences->getSyncIndexById(syncId);
+        if (index < 0 || !preferences->isFolderActive(index))
+        {
+            continue;
+        }
+
+        MegaNode *node = megaApi->getNodeByHandle(preferences->getMegaFolderHandle(index));
+        if (!node)
+        {
+            preferences->setSyncState(index, false);
+            continue;
+        }
+
+        QString localFolder = preferences->getLocalFolder(index);
+        resumingHandles.insert(node->getHandle(), QDateTime::currentMSecsSinceEpoch());
+        if (repaired)
+        {
+            //Without a local cache, the sync is added as a new one
+            MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Adding repaired sync %1: %2")
+                         .arg(syncId).arg(localFolder).toUtf8().constData());
+            megaApi->syncFolder(QDir::toNativeSeparators(localFolder).toUtf8().constData(), node);
+        }
+        else
+        {
+            MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Resuming sync %1: %2")
+                         .arg(syncId).arg(localFolder).toUtf8().constData());
+            megaApi->resumeSync(localFolder.toUtf8().constData(), node, preferences->getLocalFingerprint(index));
+        }
+        delete node;
+    }
+
+    //The timer is armed for the oldest scan
+    scanTimer.stop();
+    if (!resumingHandles.isEmpty())
+    {
+        long long oldest = QDateTime::currentMSecsSinceEpoch();
+        QHash<MegaHandle, long long>::const_iterator it;
+        for (it = resumingHandles.constBegin(); it != resumingHandles.constEnd(); ++it)
+        {
+            oldest = qMin(oldest, it.value());
+        }
+        long long remaining = oldest + Preferences::SYNC_RESUME_SCAN_TIMEOUT_MS - QDateTime::currentMSecsSinceEpoch();
+        scanTimer.start(qMax(0LL, remaining));
+    }
+
+    if (resuming && pendingSyncIds.isEmpty() && resumingHandles.isEmpty())
+    {
+        resuming = false;
+        StartupProfiler::instance()->end(QString::fromUtf8("resumeSyncs"));
+    }
+}
+
+void SyncResumer::removeTemporaryFiles(const QString &localFolder)
+{
+    QString tmpPath = localFolder
+            + QDir::separator()
+            + QString::fromUtf8(mega::MEGA_DEBRIS_FOLDER)
+            + QString::fromUtf8("/tmp");
+    QDirIterator di(tmpPath, QDir::Files | QDir::NoDotAndDotDot);
+    while (di.hasNext())
+    {
+        di.next();
+        const QFileInfo& fi = di.fileInfo();
+        if (fi.fileName().endsWith(QString::fromAscii(".mega")))
+        {
+            QFile::remove(di.filePath());
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef SYNCRESUMER_H
+#define SYNCRESUMER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QQueue>
+#include <QSet>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QTimer>
+#include <megaapi.h>
+#include "QTMegaRequestListener.h"
+
+//Resumes the syncs after fetchnodes.
+//The temporary files of all the syncs are removed in parallel in the global
+//thread pool and then the syncs are resumed in order, with at most
+//Preferences::maxConcurrentSyncResumes() initial scans running at the same time.
+//A sync keeps its slot until it leaves the initial scan, or for
+//Preferences::SYNC_RESUME_SCAN_TIMEOUT_MS at most.
+//Repaired syncs are added again with the same limit
+class SyncResumer : public QObject, public mega::MegaRequestListener
+{
+    Q_OBJECT
+
+public:
+    explicit SyncResumer(mega::MegaApi *megaApi, QObject *parent = 0);
+    virtual ~SyncResumer();
+
+    bool isResuming();
+
+public slots:
+    //Can be invoked from any thread with a queued call
+    void resumeSyncs();
+    //Removes the syncs with their local caches and adds them again when the
+    //removals finish, so the engine compares their whole folders with the cloud
+    void repairSyncs(QList<int> syncIds);
+    //Called when the request to resume or add a sync has finished
+    void onSyncAdded(mega::MegaHandle handle, int errorCode);
+    //Called when the state of a sync changes
+    void onSyncStateChanged(mega::MegaHandle handle, int state);
+
+public:
+    virtual void onRequestFinish(mega::MegaApi *api, mega::MegaRequest *request, mega::MegaError *e);
+
+protected slots:
+    void onCleanupFinished();
+    void onScanTimeout();
+
+protected:
+    void resumeNextSyncs();
+    void releaseSlot(mega::MegaHandle handle);
+    static void removeTemporaryFiles(const QString &localFolder);
+
+    mega::MegaApi *megaApi;
+    mega::QTMegaRequestListener *delegateListener;
+    QFutureWatcher<void> cleanupWatcher;
+    QStringList cleanupFolders;
+    QQueue<int> pendingSyncIds;
+    //Start time of the syncs in their initial scan, by handle
+    QHash<mega::MegaHandle, long long> resumingHandles;
+    QTimer scanTimer;
+    //Syncs being removed to be repaired, by handle, and repaired syncs waiting to be added
+    QHash<mega::MegaHandle, int> removingSyncIds;
+    QSet<int> repairedSyncIds;
+    bool resuming;
+};
+
+#endif // SYNCRESUMER_H
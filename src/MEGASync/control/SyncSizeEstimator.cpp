@@ -0,0 +1,187 @@
+#include "SyncSizeEstimator.h"
+#include "Preferences.h"
+#include "megaapi.h"
+#include <QDir>
+#include <QDateTime>
+#include <QtCore>
+
+#if QT_VERSION >= 0x050000
+#include <QtConcurrent/QtConcurrent>
+#endif
+
+using namespace mega;
+
+static bool biggerFolder(const QPair<QString, long long> &a, const QPair<QString, long long> &b)
+{
+    return a.second > b.second;
+}
+
+SyncSizeReport::SyncSizeReport()
+{
+    numFiles = 0;
+    numFolders = 0;
+    totalBytes = 0;
+    excludedFiles = 0;
+    excludedBytes = 0;
+    cancelled = false;
+    elapsedMs = 0;
+}
+
+SyncSizeEstimator::SyncSizeEstimator(QObject *parent) : QObject(parent)
+{
+    walker = NULL;
+    cancelRequested = false;
+    connect(&watcher, SIGNAL(finished()), this, SLOT(onScanFinished()));
+}
+
+SyncSizeEstimator::~SyncSizeEstimator()
+{
+    cancel();
+    watcher.waitForFinished();
+}
+
+void SyncSizeEstimator::estimate(QString localFolder, const ExclusionRules &rules)
+{
+    if (watcher.isRunning())
+    {
+        cancel();
+        watcher.waitForFinished();
+    }
+
+    walkerMutex.lock();
+    cancelRequested = false;
+    walkerMutex.unlock();
+
+    report = SyncSizeReport();
+    watcher.setFuture(QtConcurrent::run(SyncSizeEstimator::scan, localFolder, rules, this));
+}
+
+void SyncSizeEstimator::cancel()
+{
+    QMutexLocker locker(&walkerMutex);
+    cancelRequested = true;
+    if (walker)
+    {
+        walker->cancel();
+    }
+}
+
+bool SyncSizeEstimator::isRunning()
+{
+    return watcher.isRunning();
+}
+
+SyncSizeReport SyncSizeEstimator::getReport()
+{
+    return report;
+}
+
+long long SyncSizeEstimator::estimateUploadTime(const SyncSizeReport &report, long long bytesPerSecond)
+{
+    if (bytesPerSecond <= 0)
+    {
+        return -1;
+    }
+
+    return (report.totalBytes - report.excludedBytes) / bytesPerSecond;
+}
+
+void SyncSizeEstimator::onScanFinished()
+{
+    report = watcher.result();
+    MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("Local folder scanned in %1 ms: %2 (%3 files, %4 folders, %5 bytes, %6 bytes excluded)%7")
+                 .arg(report.elapsedMs).arg(report.localFolder).arg(report.numFiles).arg(report.numFolders)
+                 .arg(report.totalBytes).arg(report.excludedBytes)
+                 .arg(report.cancelled ? QString::fromUtf8(" cancelled") : QString()).toUtf8().constData());
+    emit estimateFinished(report);
+}
+
+SyncSizeReport SyncSizeEstimator::scan(QString localFolder, ExclusionRules rules, SyncSizeEstimator *estimator)
+{
+    SyncSizeReport report;
+    long long startTime = QDateTime::currentMSecsSinceEpoch();
+    report.localFolder = localFolder;
+
+    SizeVisitor visitor(rules);
+    FileSystemWalker walker(FileSystemWalker::WALK_SIZES, &visitor);
+
+    estimator->walkerMutex.lock();
+    if (estimator->cancelRequested)
+    {
+        estimator->walkerMutex.unlock();
+        report.cancelled = true;
+        return report;
+    }
+    estimator->walker = &walker;
+    estimator->walkerMutex.unlock();
+
+    report.cancelled = !walker.walk(localFolder);
+
+    estimator->walkerMutex.lock();
+    estimator->walker = NULL;
+    estimator->walkerMutex.unlock();
+
+    report.numFiles = walker.getNumFiles();
+    report.numFolders = walker.getNumFolders();
+    report.totalBytes = walker.getTotalSize();
+    report.excludedFiles = visitor.excludedFiles;
+    report.excludedBytes = visitor.excludedBytes;
+
+    for (QHash<QString, long long>::const_iterator it = visitor.rootFolderSizes.constBegin();
+         it != visitor.rootFolderSizes.constEnd(); ++it)
+    {
+        report.biggestFolders.append(qMakePair(it.key(), it.value()));
+    }
+    qSort(report.biggestFolders.begin(), report.biggestFolders.end(), biggerFolder);
+    while (report.biggestFolders.size() > Preferences::SYNC_SIZE_REPORT_MAX_FOLDERS)
+    {
+        report.biggestFolders.removeLast();
+    }
+
+    report.elapsedMs = QDateTime::currentMSecsSinceEpoch() - startTime;
+    return report;
+}
+
+SyncSizeEstimator::SizeVisitor::SizeVisitor(const ExclusionRules &rules)
+{
+    this->rules = rules;
+    this->excludedFiles = 0;
+    this->excludedBytes = 0;
+}
+
+void SyncSizeEstimator::SizeVisitor::visit(const QString &, const QString &relativePath, bool isFolder, long long size)
+{
+    //Folders are visited before their contents,
+    //so an excluded folder is known before its children
+    int separatorIndex = relativePath.lastIndexOf(QDir::separator());
+    QString parent = separatorIndex < 0 ? QString() : relativePath.left(separatorIndex);
+    QString name = relativePath.mid(separatorIndex + 1);
+    bool excluded = rules.isExcluded(name, isFolder, size);
+
+    QMutexLocker locker(&mutex);
+    if (!excluded && !parent.isEmpty() && excludedFolders.contains(parent))
+    {
+        excluded = true;
+    }
+
+    if (isFolder)
+    {
+        if (excluded)
+        {
+            excludedFolders.insert(relativePath);
+        }
+        return;
+    }
+
+    if (excluded)
+    {
+        excludedFiles++;
+        excludedBytes += size;
+    }
+
+    if (!parent.isEmpty())
+    {
+        QString rootFolder = relativePath.left(relativePath.indexOf(QDir::separator()));
+        rootFolderSizes[rootFolder] += size;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef SYNCSIZEESTIMATOR_H
+#define SYNCSIZEESTIMATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QFutureWatcher>
+#include "ExclusionEvaluator.h"
+#include "FileSystemWalker.h"
+
+//Contents of a local folder before it's synced
+class SyncSizeReport
+{
+public:
+    SyncSizeReport();
+
+    QString localFolder;
+    long long numFiles;
+    long long numFolders;
+    long long totalBytes;
+    //Entries that the current exclusion settings would skip (included in the totals)
+    long long excludedFiles;
+    long long excludedBytes;
+    //Biggest folders in the root of the local folder (name, bytes), from the biggest one
+    QList<QPair<QString, long long> > biggestFolders;
+    bool cancelled;
+    long long elapsedMs;
+};
+
+//Scans a local folder in the global thread pool before it's synced
+class SyncSizeEstimator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SyncSizeEstimator(QObject *parent = 0);
+    virtual ~SyncSizeEstimator();
+
+    //Cancels the previous estimation, if any
+    void estimate(QString localFolder, const ExclusionRules &rules);
+    void cancel();
+    bool isRunning();
+    SyncSizeReport getReport();
+
+    //Seconds to upload the bytes that would be synced, -1 if the speed is unknown
+    static long long estimateUploadTime(const SyncSizeReport &report, long long bytesPerSecond);
+
+signals:
+    void estimateFinished(const SyncSizeReport &report);
+
+protected slots:
+    void onScanFinished();
+
+protected:
+    class SizeVisitor : public FileSystemVisitor
+    {
+    public:
+        explicit SizeVisitor(const ExclusionRules &rules);
+
+        void visit(const QString &path, const QString &relativePath, bool isFolder, long long size);
+
+        ExclusionRules rules;
+        QMutex mutex;
+        QSet<QString> excludedFolders;
+        QHash<QString, long long> rootFolderSizes;
+        long long excludedFiles;
+        long long excludedBytes;
+    };
+
+    static SyncSizeReport scan(QString localFolder, ExclusionRules rules, SyncSizeEstimator *estimator);
+
+    QFutureWatcher<SyncSizeReport> watcher;
+    SyncSizeReport report;
+    QMutex walkerMutex;
+    FileSystemWalker *walker;
+    bool cancelRequested;
+};
+
+#endif // SYNCSIZEESTIMATOR_H
@@ -0,0 +1,129 @@
+#include "TransferEstimator.h"
+#include <math.h>
+
+const long long TransferEstimator::WINDOW_MS                = 10000;
+const long long TransferEstimator::MIN_SAMPLE_INTERVAL_MS   = 200;
+const long long TransferEstimator::STALL_TIMEOUT_MS         = 10000;
+const double TransferEstimator::SMOOTHING_FACTOR            = 0.2;
+
+TransferEstimator::TransferEstimator()
+{
+    reset();
+}
+
+void TransferEstimator::addSample(long long timestamp, long long transferredBytes)
+{
+    if (samples.isEmpty()
+            || transferredBytes < lastBytes
+            || (timestamp - lastTimestamp) > STALL_TIMEOUT_MS)
+    {
+        //First sample, retry or resume after a pause. The bytes
+        //transferred before this point don't count for the rate
+        samples.clear();
+        samples.enqueue(qMakePair(timestamp, transferredBytes));
+        lastTimestamp = timestamp;
+        lastBytes = transferredBytes;
+        return;
+    }
+
+    lastTimestamp = timestamp;
+    lastBytes = transferredBytes;
+    if ((timestamp - samples.last().first) < MIN_SAMPLE_INTERVAL_MS)
+    {
+        return;
+    }
+
+    samples.enqueue(qMakePair(timestamp, transferredBytes));
+    while (samples.size() > 2 && (timestamp - samples.first().first) > WINDOW_MS)
+    {
+        samples.dequeue();
+    }
+
+    long long elapsed = timestamp - samples.first().first;
+    if (elapsed <= 0)
+    {
+        return;
+    }
+
+    double windowRate = (transferredBytes - samples.first().second) * 1000.0 / elapsed;
+    if (hasRate)
+    {
+        rate += SMOOTHING_FACTOR * (windowRate - rate);
+    }
+    else
+    {
+        rate = windowRate;
+        hasRate = true;
+    }
+}
+
+void TransferEstimator::reset()
+{
+    samples.clear();
+    lastTimestamp = 0;
+    lastBytes = 0;
+    rate = 0;
+    hasRate = false;
+}
+
+double TransferEstimator::getRate(long long now)
+{
+    if (!hasRate || (now - lastTimestamp) > STALL_TIMEOUT_MS)
+    {
+        return 0;
+    }
+    return rate;
+}
+
+long long TransferEstimator::getRemainingSeconds(long long remainingBytes, long long now)
+{
+    if (remainingBytes <= 0)
+    {
+        return 0;
+    }
+
+    double currentRate = getRate(now);
+    if (currentRate <= 0)
+    {
+        return -1;
+    }
+    return (long long)ceil(remainingBytes / currentRate);
+}
+
+void TransferEstimatorMap::addSample(int tag, long long timestamp, long long transferredBytes, long long totalBytes)
+{
+    TransferProgress &progress = transfers[tag];
+    progress.estimator.addSample(timestamp, transferredBytes);
+    progress.transferredBytes = transferredBytes;
+    progress.totalBytes = totalBytes;
+}
+
+void TransferEstimatorMap::remove(int tag)
+{
+    transfers.remove(tag);
+}
+
+void TransferEstimatorMap::clear()
+{
+    transfers.clear();
+}
+
+double TransferEstimatorMap::getRate(int tag, long long now)
+{
+    QHash<int, TransferProgress>::iterator it = transfers.find(tag);
+    if (it == transfers.end())
+    {
+        return 0;
+    }
+    return it->estimator.getRate(now);
+}
+
+long long TransferEstimatorMap::getRemainingSeconds(int tag, long long now)
+{
+    QHash<int, TransferProgress>::iterator it = transfers.find(tag);
+    if (it == transfers.end())
+    {
+        return -1;
+    }
+    return it->estimator.getRemainingSeconds(it->totalBytes - it->transferredBytes, now);
+}
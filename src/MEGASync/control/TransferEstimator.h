@@ -0,0 +1,69 @@
+#ifndef TRANSFERESTIMATOR_H
+#define TRANSFERESTIMATOR_H
+
+#include <QQueue>
+#include <QPair>
+#include <QHash>
+
+//Throughput and ETA estimation for a stream of progress samples.
+//The rate is measured over a sliding window and smoothed with an EWMA.
+//Timestamps are provided by the caller (in ms), so the estimator has no
+//dependencies on the clock or on the SDK
+class TransferEstimator
+{
+public:
+    TransferEstimator();
+
+    //Adds the total number of bytes transferred at a point in time.
+    //A decrease of the transferred bytes (retry) or a long time without
+    //samples (pause) starts a new window but keeps the smoothed rate
+    void addSample(long long timestamp, long long transferredBytes);
+    void reset();
+
+    //Bytes per second, 0 if unknown or if the transfer is stalled at "now"
+    double getRate(long long now);
+
+    //Seconds needed to transfer the remaining bytes, -1 if unknown
+    long long getRemainingSeconds(long long remainingBytes, long long now);
+
+    static const long long WINDOW_MS;
+    static const long long MIN_SAMPLE_INTERVAL_MS;
+    static const long long STALL_TIMEOUT_MS;
+    static const double SMOOTHING_FACTOR;
+
+protected:
+    QQueue<QPair<long long, long long> > samples;
+    long long lastTimestamp;
+    long long lastBytes;
+    double rate;
+    bool hasRate;
+};
+
+//Estimators of individual transfers, identified by their tag
+class TransferEstimatorMap
+{
+public:
+    //The transfer is added with its first sample
+    void addSample(int tag, long long timestamp, long long transferredBytes, long long totalBytes);
+    void remove(int tag);
+    void clear();
+
+    //Same as TransferEstimator. Unknown transfers have no rate (0) nor remaining time (-1)
+    double getRate(int tag, long long now);
+    long long getRemainingSeconds(int tag, long long now);
+
+protected:
+    class TransferProgress
+    {
+    public:
+        TransferProgress() : transferredBytes(0), totalBytes(0) {}
+
+        TransferEstimator estimator;
+        long long transferredBytes;
+        long long totalBytes;
+    };
+
+    QHash<int, TransferProgress> transfers;
+};
+
+#endif // TRANSFERESTIMATOR_H
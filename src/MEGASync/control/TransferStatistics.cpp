@@ -0,0 +1,237 @@
+#include "TransferStatistics.h"
+#include "Preferences.h"
+#include <QDateTime>
+
+using namespace mega;
+
+TransferStatistics::TransferStatistics(QObject *parent) :
+    QObject(parent)
+{
+    dirty = false;
+    for (int i = 0; i < 2; i++)
+    {
+        lastStarted[i] = 0;
+        displayedTransfer[i] = NULL;
+        displayedTransferredBytes[i] = 0;
+    }
+
+    publishTimer.setSingleShot(false);
+    publishTimer.setInterval(Preferences::TRANSFER_STATS_PUBLISH_INTERVAL_MS);
+    connect(&publishTimer, SIGNAL(timeout()), this, SLOT(publish()));
+}
+
+TransferStatistics::~TransferStatistics()
+{
+    for (int i = 0; i < 2; i++)
+    {
+        delete displayedTransfer[i];
+    }
+}
+
+void TransferStatistics::onTransferStart(MegaTransfer *transfer)
+{
+    int type = transfer->getType() == MegaTransfer::TYPE_DOWNLOAD ? 0 : 1;
+
+    QMutexLocker locker(&mutex);
+    TransferState &state = transfers[transfer->getTag()];
+    state.type = type;
+    state.totalBytes = transfer->getTotalBytes();
+    state.transferredBytes = transfer->getTransferredBytes();
+    state.startTime = transfer->getStartTime();
+    state.speed = 0;
+
+    //A transfer restarted with the same tag doesn't keep its previous rate
+    transferEstimators.remove(transfer->getTag());
+    transferEstimators.addSample(transfer->getTag(), QDateTime::currentMSecsSinceEpoch(),
+                                 state.transferredBytes, state.totalBytes);
+
+    stats[type].speed = 0;
+    stats[type].totalBytes += transfer->getTotalBytes();
+    markDirty();
+}
+
+void TransferStatistics::onTransferUpdate(MegaTransfer *transfer)
+{
+    int type = transfer->getType() == MegaTransfer::TYPE_DOWNLOAD ? 0 : 1;
+
+    QMutexLocker locker(&mutex);
+    QHash<int, TransferState>::iterator it = transfers.find(transfer->getTag());
+    if (it == transfers.end())
+    {
+        stats[type].transferredBytes += transfer->getDeltaSize();
+        it = transfers.insert(transfer->getTag(), TransferState());
+    }
+    else
+    {
+        //Updates can be coalesced, so the progress is taken from the
+        //latest state instead of adding the delta of each update
+        stats[type].transferredBytes += transfer->getTransferredBytes() - it->transferredBytes;
+    }
+
+    TransferState &state = it.value();
+    state.type = type;
+    state.totalBytes = transfer->getTotalBytes();
+    state.transferredBytes = transfer->getTransferredBytes();
+    state.startTime = transfer->getStartTime();
+    state.speed = transfer->getSpeed();
+    stats[type].speed = state.speed;
+
+    long long now = QDateTime::currentMSecsSinceEpoch();
+    estimators[type].addSample(now, stats[type].transferredBytes);
+    transferEstimators.addSample(transfer->getTag(), now, state.transferredBytes, state.totalBytes);
+
+    if (!lastStarted[type] || !state.transferredBytes)
+    {
+        lastStarted[type] = state.startTime;
+    }
+
+    if (state.startTime >= lastStarted[type])
+    {
+        setDisplayedTransfer(transfer);
+    }
+    markDirty();
+}
+
+void TransferStatistics::onTransferFinish(MegaTransfer *transfer, int errorCode)
+{
+    int type = transfer->getType() == MegaTransfer::TYPE_DOWNLOAD ? 0 : 1;
+
+    QMutexLocker locker(&mutex);
+    QHash<int, TransferState>::iterator it = transfers.find(transfer->getTag());
+    if (it == transfers.end())
+    {
+        stats[type].transferredBytes += transfer->getDeltaSize();
+    }
+    else
+    {
+        stats[type].transferredBytes += transfer->getTransferredBytes() - it->transferredBytes;
+        transfers.erase(it);
+    }
+    transferEstimators.remove(transfer->getTag());
+    stats[type].speed = transfer->getSpeed();
+    estimators[type].addSample(QDateTime::currentMSecsSinceEpoch(), stats[type].transferredBytes);
+
+    if (errorCode == MegaError::API_OK && transfer->getStartTime() >= lastStarted[type])
+    {
+        setDisplayedTransfer(transfer);
+    }
+
+    if (lastStarted[type] == transfer->getStartTime())
+    {
+        lastStarted[type] = 0;
+    }
+    markDirty();
+}
+
+void TransferStatistics::reset()
+{
+    QMutexLocker locker(&mutex);
+    transfers.clear();
+    transferEstimators.clear();
+    for (int i = 0; i < 2; i++)
+    {
+        stats[i] = TransferDirectionStats();
+        estimators[i].reset();
+        lastStarted[i] = 0;
+        delete displayedTransfer[i];
+        displayedTransfer[i] = NULL;
+        displayedTransferredBytes[i] = 0;
+    }
+}
+
+TransferDirectionStats TransferStatistics::getStats(int type)
+{
+    QMutexLocker locker(&mutex);
+    return stats[type == MegaTransfer::TYPE_DOWNLOAD ? 0 : 1];
+}
+
+bool TransferStatistics::isEmpty()
+{
+    QMutexLocker locker(&mutex);
+    return !stats[0].totalBytes && !stats[1].totalBytes;
+}
+
+double TransferStatistics::getRate(int type)
+{
+    QMutexLocker locker(&mutex);
+    return estimators[type == MegaTransfer::TYPE_DOWNLOAD ? 0 : 1].getRate(QDateTime::currentMSecsSinceEpoch());
+}
+
+long long TransferStatistics::getRemainingSeconds(int type)
+{
+    int index = type == MegaTransfer::TYPE_DOWNLOAD ? 0 : 1;
+
+    QMutexLocker locker(&mutex);
+    return estimators[index].getRemainingSeconds(stats[index].totalBytes - stats[index].transferredBytes,
+                                                 QDateTime::currentMSecsSinceEpoch());
+}
+
+double TransferStatistics::getTransferRate(int tag)
+{
+    QMutexLocker locker(&mutex);
+    return transferEstimators.getRate(tag, QDateTime::currentMSecsSinceEpoch());
+}
+
+long long TransferStatistics::getTransferRemainingSeconds(int tag)
+{
+    QMutexLocker locker(&mutex);
+    return transferEstimators.getRemainingSeconds(tag, QDateTime::currentMSecsSinceEpoch());
+}
+
+MegaTransfer *TransferStatistics::getDisplayedTransfer(int type)
+{
+    QMutexLocker locker(&mutex);
+    return displayedTransfer[type == MegaTransfer::TYPE_DOWNLOAD ? 0 : 1];
+}
+
+long long TransferStatistics::getDisplayedTransferredBytes(int type)
+{
+    QMutexLocker locker(&mutex);
+    return displayedTransferredBytes[type == MegaTransfer::TYPE_DOWNLOAD ? 0 : 1];
+}
+
+void TransferStatistics::flush()
+{
+    publish();
+}
+
+void TransferStatistics::publish()
+{
+    mutex.lock();
+    bool changed = dirty;
+    dirty = false;
+    if (!changed)
+    {
+        //Nothing happened since the last snapshot, stop waking up
+        publishTimer.stop();
+    }
+    mutex.unlock();
+
+    if (changed)
+    {
+        emit snapshotReady();
+    }
+}
+
+void TransferStatistics::setDisplayedTransfer(MegaTransfer *transfer)
+{
+    int type = transfer->getType() == MegaTransfer::TYPE_DOWNLOAD ? 0 : 1;
+    displayedTransferredBytes[type] = transfer->getTransferredBytes();
+
+    //The transfer is only copied when another one is shown,
+    //the copy is needed to cancel it from InfoDialog
+    if (!displayedTransfer[type] || displayedTransfer[type]->getTag() != transfer->getTag())
+    {
+        delete displayedTransfer[type];
+        displayedTransfer[type] = transfer->copy();
+    }
+}
+
+void TransferStatistics::markDirty()
+{
+    dirty = true;
+    if (!publishTimer.isActive())
+    {
+        QMetaObject::invokeMethod(&publishTimer, "start", Qt::QueuedConnection);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef TRANSFERSTATISTICS_H
+#define TRANSFERSTATISTICS_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+#include "megaapi.h"
+#include "TransferEstimator.h"
+
+//Latest known state of a transfer
+class TransferState
+{
+public:
+    TransferState() : type(0), transferredBytes(0), totalBytes(0), speed(0), startTime(0) {}
+
+    int type;
+    long long transferredBytes;
+    long long totalBytes;
+    long long speed;
+    long long startTime;
+};
+
+//Aggregated statistics for one direction (downloads or uploads)
+class TransferDirectionStats
+{
+public:
+    TransferDirectionStats() : totalBytes(0), transferredBytes(0), speed(0) {}
+
+    long long totalBytes;
+    long long transferredBytes;
+    long long speed;
+};
+
+//Absorbs transfer callbacks cheaply and publishes snapshots of the statistics
+//at a fixed rate, so the GUI isn't updated once per SDK callback
+class TransferStatistics : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TransferStatistics(QObject *parent = 0);
+    virtual ~TransferStatistics();
+
+    void onTransferStart(mega::MegaTransfer *transfer);
+    void onTransferUpdate(mega::MegaTransfer *transfer);
+    void onTransferFinish(mega::MegaTransfer *transfer, int errorCode);
+    void reset();
+
+    TransferDirectionStats getStats(int type);
+    bool isEmpty();
+
+    //Throughput (bytes per second) and remaining time (seconds, -1 if unknown)
+    //for a direction or for an active transfer, identified by its tag
+    double getRate(int type);
+    long long getRemainingSeconds(int type);
+    double getTransferRate(int tag);
+    long long getTransferRemainingSeconds(int tag);
+
+    //Transfer that should be shown for a direction (the most recently started one).
+    //The object belongs to this class and is only replaced when another transfer is shown,
+    //so its progress is outdated. The current progress is returned by getDisplayedTransferredBytes
+    mega::MegaTransfer *getDisplayedTransfer(int type);
+    long long getDisplayedTransferredBytes(int type);
+
+    //Emits snapshotReady() now if there are pending changes
+    void flush();
+
+signals:
+    void snapshotReady();
+
+protected slots:
+    void publish();
+
+protected:
+    void setDisplayedTransfer(mega::MegaTransfer *transfer);
+    void markDirty();
+
+    QMutex mutex;
+    QTimer publishTimer;
+    bool dirty;
+    QHash<int, TransferState> transfers;
+    TransferDirectionStats stats[2];
+    TransferEstimator estimators[2];
+    TransferEstimatorMap transferEstimators;
+    long long lastStarted[2];
+    mega::MegaTransfer *displayedTransfer[2];
+    long long displayedTransferredBytes[2];
+};
+
+#endif // TRANSFERSTATISTICS_H
@@ -1,5 +1,7 @@
 #include "Utilities.h"
 #include "control/Preferences.h"
+#include "control/FileSystemWalker.h"
+#include "control/FileCopier.h"
 
 #include <QApplication>
 #include <QImageReader>
@@ -17,6 +19,7 @@ using namespace std;
 
 QHash<QString, QString> Utilities::extensionIcons;
 QHash<QString, QString> Utilities::languageNames;
+QHash<QString, QIcon> Utilities::smallExtensionIcons;
 
 void Utilities::initializeExtensions()
 {
@@ -160,8 +163,6 @@ void Utilities::countFilesAndFolders(QString path, long *numFiles, long *numFold
         return;
     }
 
-    QApplication::processEvents();
-
 #ifdef WIN32
     if (path.startsWith(QString::fromAscii("\\\\?\\")))
     {
@@ -180,21 +181,11 @@ void Utilities::countFilesAndFolders(QString path, long *numFiles, long *numFold
         return;
     }
 
-    QDir dir(path);
-    QFileInfoList entries = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot);
-    for (int i = 0; i < entries.size(); i++)
-    {
-        QFileInfo info = entries[i];
-        if (info.isFile())
-        {
-            (*numFiles)++;
-        }
-        else if (info.isDir())
-        {
-            countFilesAndFolders(info.absoluteFilePath(), numFiles, numFolders, fileLimit, folderLimit);
-            (*numFolders)++;
-        }
-    }
+    FileSystemWalker walker(FileSystemWalker::WALK_FOLLOW_SYMLINKS);
+    walker.setLimits(fileLimit - (*numFiles), folderLimit - (*numFolders));
+    walker.walk(path);
+    (*numFiles) += walker.getNumFiles();
+    (*numFolders) += walker.getNumFolders();
 }
 
 void Utilities::getFolderSize(QString folderPath, long long *size)
@@ -204,20 +195,9 @@ void Utilities::getFolderSize(QString folderPath, long long *size)
         return;
     }
 
-    QDir dir(folderPath);
-    QFileInfoList entries = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
-    for (int i = 0; i < entries.size(); i++)
-    {
-        QFileInfo info = entries[i];
-        if (info.isFile())
-        {
-            (*size) += info.size();
-        }
-        else if (info.isDir())
-        {
-            getFolderSize(info.absoluteFilePath(), size);
-        }
-    }
+    FileSystemWalker walker(FileSystemWalker::WALK_SIZES | FileSystemWalker::WALK_FOLLOW_SYMLINKS);
+    walker.walk(folderPath);
+    (*size) += walker.getTotalSize();
 }
 
 QString Utilities::getExtensionPixmap(QString fileName, QString prefix)
@@ -308,6 +288,22 @@ QString Utilities::getExtensionPixmapMedium(QString fileName)
     return getExtensionPixmap(fileName, QString::fromAscii(":/images/drag_"));
 }
 
+QIcon Utilities::getExtensionIconSmall(QString fileName)
+{
+    //Only used from the GUI thread. The icon is shared by all the files with the same extension
+    int dot = fileName.lastIndexOf(QChar::fromAscii('.'));
+    QString extension = dot < 0 ? QString() : fileName.mid(dot + 1).toLower();
+    QHash<QString, QIcon>::const_iterator it = smallExtensionIcons.constFind(extension);
+    if (it != smallExtensionIcons.constEnd())
+    {
+        return it.value();
+    }
+
+    QIcon icon(getExtensionPixmapSmall(fileName));
+    smallExtensionIcons.insert(extension, icon);
+    return icon;
+}
+
 bool Utilities::removeRecursively(QString path)
 {
     if (!path.size())
@@ -325,47 +321,7 @@ bool Utilities::removeRecursively(QString path)
 
 void Utilities::copyRecursively(QString srcPath, QString dstPath)
 {
-    if (!srcPath.size() || !dstPath.size())
-    {
-        return;
-    }
-
-    QFileInfo source(srcPath);
-    if (!source.exists())
-    {
-        return;
-    }
-
-    if (srcPath == dstPath)
-    {
-        return;
-    }
-
-    QFile dst(dstPath);
-    if (dst.exists())
-    {
-        return;
-    }
-
-    if (source.isFile())
-    {
-        QFile src(srcPath);
-        src.copy(dstPath);
-    }
-    else if (source.isDir())
-    {
-        QDir dstDir(dstPath);
-        dstDir.mkpath(QString::fromAscii("."));
-        QDirIterator di(srcPath, QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot);
-        while (di.hasNext())
-        {
-            di.next();
-            if (!di.fileInfo().isSymLink())
-            {
-                copyRecursively(di.filePath(), dstPath + QDir::separator() + di.fileName());
-            }
-        }
-    }
+    FileCopier::copyTree(srcPath, dstPath, false);
 }
 
 bool Utilities::verifySyncedFolderLimits(QString path)
@@ -384,6 +340,19 @@ bool Utilities::verifySyncedFolderLimits(QString path)
     }
     return true;
 }
+QString Utilities::getRemainingTimeString(long long secs)
+{
+    long long hours = secs / 3600;
+    if (secs <= 0 || hours > 99)
+    {
+        return QString::fromAscii("--:--:--");
+    }
+
+    return QString::fromAscii("%1:%2:%3").arg(hours, 2, 10, QChar::fromAscii('0'))
+        .arg((secs % 3600) / 60, 2, 10, QChar::fromAscii('0'))
+        .arg(secs % 60, 2, 10, QChar::fromAscii('0'));
+}
+
 QString Utilities::getTimeString(long long secs)
 {
     int seconds = (int) secs % 60;
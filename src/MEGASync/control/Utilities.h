@@ -4,6 +4,7 @@
 #include <QString>
 #include <QHash>
 #include <QPixmap>
+#include <QIcon>
 #include <QDir>
 
 class Utilities
@@ -11,6 +12,7 @@ class Utilities
 public:
     static QString getSizeString(unsigned long long bytes);
     static QString getTimeString(long long secs);
+    static QString getRemainingTimeString(long long secs);
     static bool verifySyncedFolderLimits(QString path);
     static QString extractJSONString(QString json, QString name);
     static long long extractJSONNumber(QString json, QString name);
@@ -19,6 +21,7 @@ private:
     Utilities() {}
     static QHash<QString, QString> extensionIcons;
     static QHash<QString, QString> languageNames;
+    static QHash<QString, QIcon> smallExtensionIcons;
     static void initializeExtensions();
     static void countFilesAndFolders(QString path, long *numFiles, long *numFolders, long fileLimit, long folderLimit);
     static QString getExtensionPixmap(QString fileName, QString prefix);
@@ -28,6 +31,7 @@ public:
     static QString languageCodeToString(QString code);
     static QString getExtensionPixmapSmall(QString fileName);
     static QString getExtensionPixmapMedium(QString fileName);
+    static QIcon getExtensionIconSmall(QString fileName);
     static bool removeRecursively(QString path);
     static void copyRecursively(QString srcPath, QString dstPath);
     static void getFolderSize(QString folderPath, long long *size);
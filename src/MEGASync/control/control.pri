@@ -14,7 +14,21 @@ SOURCES += $$PWD/HTTPServer.cpp \
     $$PWD/Utilities.cpp \
     $$PWD/MegaDownloader.cpp \
     $$PWD/MegaSyncLogger.cpp \
-    $$PWD/ConnectivityChecker.cpp
+    $$PWD/ConnectivityChecker.cpp \
+    $$PWD/PublicNodeCache.cpp \
+    $$PWD/TransferStatistics.cpp \
+    $$PWD/TransferEstimator.cpp \
+    $$PWD/NodeUpdateProcessor.cpp \
+    $$PWD/StartupProfiler.cpp \
+    $$PWD/StateCacheVerifier.cpp \
+    $$PWD/SyncRescanner.cpp \
+    $$PWD/ExclusionEvaluator.cpp \
+    $$PWD/ExclusionUploader.cpp \
+    $$PWD/SyncResumer.cpp \
+    $$PWD/DebrisTracker.cpp \
+    $$PWD/FileSystemWalker.cpp \
+    $$PWD/FileCopier.cpp \
+    $$PWD/SyncSizeEstimator.cpp
 
 HEADERS  +=  $$PWD/HTTPServer.h \
     $$PWD/Preferences.h \
@@ -27,5 +41,19 @@ HEADERS  +=  $$PWD/HTTPServer.h \
     $$PWD/Utilities.h \
     $$PWD/MegaDownloader.h \
     $$PWD/MegaSyncLogger.h \
-    $$PWD/ConnectivityChecker.h
+    $$PWD/ConnectivityChecker.h \
+    $$PWD/PublicNodeCache.h \
+    $$PWD/TransferStatistics.h \
+    $$PWD/TransferEstimator.h \
+    $$PWD/NodeUpdateProcessor.h \
+    $$PWD/StartupProfiler.h \
+    $$PWD/StateCacheVerifier.h \
+    $$PWD/SyncRescanner.h \
+    $$PWD/ExclusionEvaluator.h \
+    $$PWD/ExclusionUploader.h \
+    $$PWD/SyncResumer.h \
+    $$PWD/DebrisTracker.h \
+    $$PWD/FileSystemWalker.h \
+    $$PWD/FileCopier.h \
+    $$PWD/SyncSizeEstimator.h
 
@@ -2,6 +2,7 @@
 #include "ui_BindFolderDialog.h"
 #include "MegaApplication.h"
 #include "control/Utilities.h"
+#include "SyncSizeReportDialog.h"
 #include <QInputDialog>
 
 using namespace mega;
@@ -151,6 +152,11 @@ void BindFolderDialog::on_bOK_clicked()
     }
     delete node;
 
+    if (!SyncSizeReportDialog::confirm(app, localFolderPath, this))
+    {
+        return;
+    }
+
    bool repeated;
    syncName = QFileInfo(localFolderPath).fileName();
    do
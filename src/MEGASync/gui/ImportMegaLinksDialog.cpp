@@ -380,9 +380,13 @@ void ImportMegaLinksDialog::changeEvent(QEvent *event)
     if (event->type() == QEvent::LanguageChange)
     {
         ui->retranslateUi(this);
-        int totalImports = linkProcessor->getCurrentIndex();
-        for (int i = 0; i < totalImports; i++)
-            this->onLinkInfoAvailable(i);
+        for (int i = 0; i < linkProcessor->size(); i++)
+        {
+            if (linkProcessor->isResolved(i))
+            {
+                this->onLinkInfoAvailable(i);
+            }
+        }
     }
     QDialog::changeEvent(event);
 }
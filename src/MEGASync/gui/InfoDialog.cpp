@@ -44,17 +44,18 @@ InfoDialog::InfoDialog(MegaApplication *app, QWidget *parent) :
     totalDownloadedSize = totalUploadedSize = 0;
     totalDownloadSize = totalUploadSize = 0;
     remainingUploads = remainingDownloads = 0;
-    uploadStartTime = 0;
-    downloadStartTime = 0;
-    effectiveDownloadSpeed = 200000;
-    effectiveUploadSpeed = 200000;
+    remainingDownloadSeconds = remainingUploadSeconds = -1;
     ui->lDownloads->setText(QString::fromAscii(""));
     ui->lUploads->setText(QString::fromAscii(""));
     indexing = false;
     waiting = false;
+    localCopyBytes = 0;
+    localCopyTotalBytes = 0;
     syncsMenu = NULL;
     activeDownload = NULL;
     activeUpload = NULL;
+    activeDownloadBytes = 0;
+    activeUploadBytes = 0;
     transferMenu = NULL;
     gWidget = NULL;
 
@@ -181,7 +182,7 @@ void InfoDialog::setUsage()
     ui->lTotalUsed->setText(tr("Usage: %1").arg(Utilities::getSizeString(preferences->usedStorage())));
 }
 
-void InfoDialog::setTransfer(MegaTransfer *transfer)
+void InfoDialog::setTransfer(MegaTransfer *transfer, long long transferredBytes)
 {
     if (!transfer)
     {
@@ -190,7 +191,7 @@ void InfoDialog::setTransfer(MegaTransfer *transfer)
 
     int type = transfer->getType();
     QString fileName = QString::fromUtf8(transfer->getFileName());
-    long long completedSize = transfer->getTransferredBytes();
+    long long completedSize = transferredBytes;
     long long totalSize = transfer->getTotalBytes();
 
     ActiveTransfer *wTransfer;
@@ -202,13 +203,7 @@ void InfoDialog::setTransfer(MegaTransfer *transfer)
             delete activeDownload;
             activeDownload = transfer->copy();
         }
-
-        if (!downloadStartTime)
-        {
-            downloadStartTime = QDateTime::currentMSecsSinceEpoch();
-            elapsedDownloadTime=0;
-            lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        }
+        activeDownloadBytes = transferredBytes;
     }
     else
     {
@@ -218,13 +213,7 @@ void InfoDialog::setTransfer(MegaTransfer *transfer)
             delete activeUpload;
             activeUpload = transfer->copy();
         }
-
-        if (!uploadStartTime)
-        {
-            uploadStartTime = QDateTime::currentMSecsSinceEpoch();
-            elapsedUploadTime=0;
-            lastUpdate = QDateTime::currentMSecsSinceEpoch();
-        }
+        activeUploadBytes = transferredBytes;
     }
 
     bool shown = wTransfer->isVisible();
@@ -292,49 +281,9 @@ void InfoDialog::updateTransfers()
 
     if (remainingDownloads)
     {
-        long long remainingBytes = totalDownloadSize-totalDownloadedSize;
-        if (remainingBytes < 0)
-        {
-            remainingBytes = 0;
-        }
-
-        unsigned long long timeIncrement = QDateTime::currentMSecsSinceEpoch()-lastUpdate;
-        if (timeIncrement < 1000)
-        {
-            elapsedDownloadTime += timeIncrement;
-        }
-
-        double effectiveSpeed = effectiveDownloadSpeed;
-        double elapsedDownloadTimeSecs = elapsedDownloadTime/1000.0;
-        if (elapsedDownloadTimeSecs)
-        {
-            effectiveSpeed = totalDownloadedSize/elapsedDownloadTimeSecs;
-        }
-
-        effectiveDownloadSpeed += (effectiveSpeed-effectiveDownloadSpeed)/3; //Smooth the effective speed
         if (isVisible())
         {
-            int totalRemainingSeconds = (effectiveDownloadSpeed) ? remainingBytes/effectiveDownloadSpeed : 0;
-            int remainingHours = totalRemainingSeconds/3600;
-            if ((remainingHours<0) || (remainingHours>99))
-            {
-                totalRemainingSeconds = 0;
-            }
-
-            int remainingMinutes = (totalRemainingSeconds%3600)/60;
-            int remainingSeconds =  (totalRemainingSeconds%60);
-            QString remainingTime;
-            if (totalRemainingSeconds)
-            {
-                remainingTime = QString::fromAscii("%1:%2:%3").arg(remainingHours, 2, 10, QChar::fromAscii('0'))
-                    .arg(remainingMinutes, 2, 10, QChar::fromAscii('0'))
-                    .arg(remainingSeconds, 2, 10, QChar::fromAscii('0'));
-            }
-            else
-            {
-                remainingTime = QString::fromAscii("--:--:--");
-            }
-
+            QString remainingTime = Utilities::getRemainingTimeString(remainingDownloadSeconds);
             !preferences->logged() ? gWidget->setRemainingTime(remainingTime)
                       : ui->lRemainingTimeD->setText(remainingTime);
             ui->wDownloadDesc->show();
@@ -395,50 +344,9 @@ void InfoDialog::updateTransfers()
 
     if (remainingUploads)
     {
-        long long remainingBytes = totalUploadSize-totalUploadedSize;
-        if (remainingBytes < 0)
-        {
-            remainingBytes = 0;
-        }
-
-        unsigned long long timeIncrement = QDateTime::currentMSecsSinceEpoch()-lastUpdate;
-        if (timeIncrement < 1000)
-        {
-            elapsedUploadTime += timeIncrement;
-        }
-
-        double effectiveSpeed = effectiveUploadSpeed;
-        double elapsedUploadTimeSecs = elapsedUploadTime / 1000.0;
-        if (elapsedUploadTimeSecs)
-        {
-            effectiveSpeed = totalUploadedSize / elapsedUploadTimeSecs;
-        }
-
-        effectiveUploadSpeed += (effectiveSpeed - effectiveUploadSpeed) / 3; //Smooth the effective speed
-
         if (isVisible())
         {
-            int totalRemainingSeconds = (effectiveUploadSpeed) ? remainingBytes/effectiveUploadSpeed : 0;
-            int remainingHours = totalRemainingSeconds/3600;
-            if ((remainingHours < 0) || (remainingHours > 99))
-            {
-                totalRemainingSeconds = 0;
-            }
-
-            int remainingMinutes = (totalRemainingSeconds%3600)/60;
-            int remainingSeconds =  (totalRemainingSeconds%60);
-            QString remainingTime;
-            if (totalRemainingSeconds)
-            {
-                remainingTime = QString::fromAscii("%1:%2:%3").arg(remainingHours, 2, 10, QChar::fromAscii('0'))
-                    .arg(remainingMinutes, 2, 10, QChar::fromAscii('0'))
-                    .arg(remainingSeconds, 2, 10, QChar::fromAscii('0'));
-            }
-            else
-            {
-                remainingTime = QString::fromAscii("--:--:--");
-            }
-
+            QString remainingTime = Utilities::getRemainingTimeString(remainingUploadSeconds);
             ui->lRemainingTimeU->setText(remainingTime);
             ui->wUploadDesc->show();
             QString fullPattern = QString::fromAscii("<span style=\"color: rgb(119, 185, 217); \">%1</span>%2");
@@ -491,8 +399,6 @@ void InfoDialog::updateTransfers()
             updateState();
         }
     }
-
-    lastUpdate = QDateTime::currentMSecsSinceEpoch();
 }
 
 void InfoDialog::transferFinished(int error)
@@ -573,7 +479,7 @@ void InfoDialog::updateSyncsButton()
     MegaNode *rootNode = megaApi->getRootNode();
     if (!rootNode)
     {
-        preferences->setCrashed(true);
+        preferences->setNeedsFullReload(true);
         ui->bSyncFolder->setText(QString::fromAscii("MEGA"));
         return;
     }
@@ -601,6 +507,14 @@ void InfoDialog::setWaiting(bool waiting)
     this->waiting = waiting;
 }
 
+void InfoDialog::setLocalCopyProgress(QString name, long long copiedBytes, long long totalBytes)
+{
+    localCopyName = name;
+    localCopyBytes = copiedBytes;
+    localCopyTotalBytes = totalBytes;
+    updateState();
+}
+
 void InfoDialog::increaseUsedStorage(long long bytes, bool isInShare)
 {
     if (isInShare)
@@ -694,6 +608,24 @@ void InfoDialog::updateState()
             ui->label->setIcon(icon);
             ui->label->setIconSize(QSize(64, 64));
         }
+        else if (localCopyTotalBytes > 0)
+        {
+            //Files copied into synced folders are uploaded by the sync engine when the copy finishes
+            if (!scanningTimer.isActive())
+            {
+                scanningAnimationIndex = 1;
+                scanningTimer.start();
+            }
+
+            ui->lSyncUpdated->setText(tr("Copying %1 (%2 of %3)").arg(localCopyName)
+                                      .arg(Utilities::getSizeString(localCopyBytes))
+                                      .arg(Utilities::getSizeString(localCopyTotalBytes)));
+
+            QIcon icon;
+            icon.addFile(QString::fromUtf8(":/images/tray_scanning_large_ico.png"), QSize(), QIcon::Normal, QIcon::Off);
+            ui->label->setIcon(icon);
+            ui->label->setIconSize(QSize(64, 64));
+        }
         else if (indexing)
         {
             if (!scanningTimer.isActive())
@@ -785,6 +717,12 @@ void InfoDialog::setTotalTransferSize(long long totalDownloadSize, long long tot
     this->totalUploadSize = totalUploadSize;
 }
 
+void InfoDialog::setRemainingTime(long long remainingDownloadSeconds, long long remainingUploadSeconds)
+{
+    this->remainingDownloadSeconds = remainingDownloadSeconds;
+    this->remainingUploadSeconds = remainingUploadSeconds;
+}
+
 void InfoDialog::setPaused(bool paused)
 {
     ui->bPause->setChecked(paused);
@@ -913,7 +851,7 @@ void InfoDialog::onAllUploadsFinished()
         ui->wTransfer2->hideTransfer();
         ui->lUploads->setText(QString::fromAscii(""));
         ui->wUploadDesc->hide();
-        uploadStartTime = 0;
+        remainingUploadSeconds = -1;
         uploadSpeed = 0;
         currentUpload = 0;
         totalUploads = 0;
@@ -940,7 +878,7 @@ void InfoDialog::onAllDownloadsFinished()
             ui->lDownloads->setText(QString::fromAscii(""));
             ui->wDownloadDesc->hide();
         }
-        downloadStartTime = 0;
+        remainingDownloadSeconds = -1;
         downloadSpeed = 0;
         currentDownload = 0;
         totalDownloads = 0;
@@ -1009,7 +947,7 @@ void InfoDialog::on_bSyncFolder_clicked()
     MegaNode *rootNode = megaApi->getRootNode();
     if (!rootNode)
     {
-        preferences->setCrashed(true);
+        preferences->setNeedsFullReload(true);
         return;
     }
 
@@ -1264,7 +1202,7 @@ void InfoDialog::regenerateLayout()
         ((QVBoxLayout *)dialogLayout)->insertWidget(dialogLayout->count(), ui->wBottom);
     }
 
-    setTransfer(activeDownload);
+    setTransfer(activeDownload, activeDownloadBytes);
     updateTransfers();
     app->onGlobalSyncStateChanged(NULL);
 }
@@ -23,18 +23,21 @@ public:
     ~InfoDialog();
 
     void setUsage();
-    void setTransfer(mega::MegaTransfer *transfer);
+    void setTransfer(mega::MegaTransfer *transfer, long long transferredBytes);
     void addRecentFile(QString fileName, long long fileHandle, QString localPath, QString nodeKey);
     void clearRecentFiles();
     void setTransferSpeeds(long long downloadSpeed, long long uploadSpeed);
     void setTransferredSize(long long totalDownloadedSize, long long totalUploadedSize);
     void setTotalTransferSize(long long totalDownloadSize, long long totalUploadSize);
+    void setRemainingTime(long long remainingDownloadSeconds, long long remainingUploadSeconds);
     void setPaused(bool paused);
     void updateTransfers();
     void transferFinished(int error);
     void updateSyncsButton();
     void setIndexing(bool indexing);
     void setWaiting(bool waiting);
+    //Progress of a copy into a synced folder. A totalBytes of 0 clears it
+    void setLocalCopyProgress(QString name, long long copiedBytes, long long totalBytes);
     void increaseUsedStorage(long long bytes, bool isInShare);
     void updateState();
     void showRecentlyUpdated(bool show);
@@ -107,13 +110,8 @@ private:
 
     long long downloadSpeed;
     long long uploadSpeed;
-    unsigned long long effectiveDownloadSpeed;
-    unsigned long long effectiveUploadSpeed;
-    unsigned long long uploadStartTime;
-    unsigned long long downloadStartTime;
-    unsigned long long elapsedDownloadTime;
-    unsigned long long elapsedUploadTime;
-    unsigned long long lastUpdate;
+    long long remainingDownloadSeconds;
+    long long remainingUploadSeconds;
     int currentUpload;
     int currentDownload;
     int totalUploads;
@@ -123,6 +121,8 @@ private:
     int remainingUploads, remainingDownloads;
     bool indexing;
     bool waiting;
+    QString localCopyName;
+    long long localCopyBytes, localCopyTotalBytes;
     GuestWidget *gWidget;
 
 protected:
@@ -144,6 +144,8 @@ protected:
     mega::MegaApi *megaApi;
     mega::MegaTransfer *activeDownload;
     mega::MegaTransfer *activeUpload;
+    long long activeDownloadBytes;
+    long long activeUploadBytes;
 };
 
 #endif // INFODIALOG_H
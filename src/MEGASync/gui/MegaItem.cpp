@@ -8,8 +8,12 @@ MegaItem::MegaItem(MegaNode *node, MegaItem *parentItem, bool showFiles)
 {
     this->node = node;
     this->children = NULL;
+    this->numListChildren = 0;
+    this->nextListChild = 0;
     this->parent = parentItem;
     this->showFiles = showFiles;
+    this->access = 0;
+    this->accessGeneration = -1;
 }
 
 mega::MegaNode *MegaItem::getNode()
@@ -20,14 +24,26 @@ mega::MegaNode *MegaItem::getNode()
 void MegaItem::setChildren(MegaNodeList *children)
 {
     this->children = children;
-    for (int i = 0; i < children->size(); i++)
+    nextListChild = 0;
+    numListChildren = children->size();
+    if (!showFiles)
     {
-        MegaNode *node = children->get(i);
-        if (!showFiles && node->getType() == MegaNode::TYPE_FILE)
+        //Folders are first in the list, so the first file is found with a binary search
+        int low = 0;
+        int high = children->size();
+        while (low < high)
         {
-            break;
+            int middle = (low + high) / 2;
+            if (children->get(middle)->getType() == MegaNode::TYPE_FILE)
+            {
+                high = middle;
+            }
+            else
+            {
+                low = middle + 1;
+            }
         }
-        childItems.append(new MegaItem(children->get(i), this, showFiles));
+        numListChildren = low;
     }
 }
 
@@ -53,36 +69,91 @@ int MegaItem::getNumChildren()
 
 int MegaItem::indexOf(MegaItem *item)
 {
+    int position = insertPosition(item->getNode());
+    for (int i = position; i < childItems.size(); i++)
+    {
+        if (childItems[i] == item)
+        {
+            return i;
+        }
+
+        if (lessThan(item->getNode(), childItems[i]->getNode()))
+        {
+            break;
+        }
+    }
+
+    //The order of the SDK can be slightly different
     return childItems.indexOf(item);
 }
 
-int MegaItem::insertPosition(MegaNode *node)
+int MegaItem::getNumPendingChildren()
 {
-    int type = node->getType();
+    return children ? numListChildren - nextListChild : 0;
+}
 
-    int i;
-    for (i = 0; i < childItems.size(); i++)
+int MegaItem::fetchChildren(int maxChildren)
+{
+    int count = qMin(maxChildren, getNumPendingChildren());
+    childItems.reserve(childItems.size() + count);
+    for (int i = 0; i < count; i++)
     {
-        MegaNode *n = childItems.at(i)->getNode();
-        int nodeType = n->getType();
-        if (type < nodeType)
+        MegaNode *child = children->get(nextListChild++);
+        MegaItem *item = new MegaItem(child, this, showFiles);
+        childItems.append(item);
+        childrenByHandle.insert(child->getHandle(), item);
+    }
+    return count;
+}
+
+MegaItem *MegaItem::findChild(MegaHandle handle)
+{
+    return childrenByHandle.value(handle);
+}
+
+int MegaItem::getListPosition(MegaHandle handle)
+{
+    if (!children)
+    {
+        return -1;
+    }
+
+    if (listPositions.isEmpty())
+    {
+        listPositions.reserve(numListChildren);
+        for (int i = 0; i < numListChildren; i++)
         {
-            continue;
+            listPositions.insert(children->get(i)->getHandle(), i);
         }
+    }
+    return listPositions.value(handle, -1);
+}
 
-        if (qstricmp(node->getName(), n->getName()) <= 0)
+int MegaItem::insertPosition(MegaNode *node)
+{
+    int low = 0;
+    int high = childItems.size();
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (lessThan(childItems[middle]->getNode(), node))
         {
-            break;
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
         }
     }
-
-    return i;
+    return low;
 }
 
 void MegaItem::insertNode(MegaNode *node, int index)
 {
-    childItems.insert(index, new MegaItem(node, this, showFiles));
-    insertedNodes.append(node);
+    MegaItem *item = new MegaItem(node, this, showFiles);
+    childItems.insert(index, item);
+    childrenByHandle.insert(node->getHandle(), item);
+    insertedNodes.insert(node->getHandle(), node);
 }
 
 void MegaItem::removeNode(MegaNode *node)
@@ -92,25 +163,18 @@ void MegaItem::removeNode(MegaNode *node)
         return;
     }
 
-    for (int i = 0; i < childItems.size(); i++)
+    MegaItem *item = childrenByHandle.take(node->getHandle());
+    if (item)
     {
-        if (childItems[i]->getNode()->getHandle() == node->getHandle())
+        int index = indexOf(item);
+        if (index >= 0)
         {
-            delete childItems[i];
-            childItems.removeAt(i);
-            break;
+            childItems.remove(index);
         }
+        delete item;
     }
 
-    for (int i = 0; i < insertedNodes.size(); i++)
-    {
-        if (insertedNodes[i]->getHandle() == node->getHandle())
-        {
-            delete insertedNodes[i];
-            insertedNodes.removeAt(i);
-            break;
-        }
-    }
+    delete insertedNodes.take(node->getHandle());
 }
 
 void MegaItem::displayFiles(bool enable)
@@ -118,10 +182,36 @@ void MegaItem::displayFiles(bool enable)
     this->showFiles = enable;
 }
 
+bool MegaItem::getCachedAccess(int generation, int *access)
+{
+    if (accessGeneration != generation)
+    {
+        return false;
+    }
+
+    *access = this->access;
+    return true;
+}
+
+void MegaItem::setCachedAccess(int access, int generation)
+{
+    this->access = access;
+    this->accessGeneration = generation;
+}
+
+bool MegaItem::lessThan(MegaNode *a, MegaNode *b)
+{
+    //Folders first, then by name
+    if (a->getType() != b->getType())
+    {
+        return a->getType() > b->getType();
+    }
+    return qstricmp(a->getName(), b->getName()) < 0;
+}
+
 MegaItem::~MegaItem()
 {
     delete children;
     qDeleteAll(childItems);
     qDeleteAll(insertedNodes);
 }
-
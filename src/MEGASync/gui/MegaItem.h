@@ -2,8 +2,14 @@
 #define MEGAITEM_H
 
 #include <QList>
+#include <QVector>
+#include <QHash>
 #include <megaapi.h>
 
+//Node of QMegaModel.
+//Children are taken from the list of the SDK but their items are created
+//page by page (fetchChildren), always in order. Loaded children are kept sorted
+//(folders first, then by name) so positions are found with a binary search
 class MegaItem
 {
 public:
@@ -18,20 +24,41 @@ public:
     int getNumChildren();
     int indexOf(MegaItem *item);
 
+    //Children in the list of the SDK without an item yet
+    int getNumPendingChildren();
+    //Creates the items of the next children of the list. Returns the number of items created
+    int fetchChildren(int maxChildren);
+    MegaItem *findChild(mega::MegaHandle handle);
+    //Position of a child in the list of the SDK or -1 if it isn't there
+    int getListPosition(mega::MegaHandle handle);
+
     int insertPosition(mega::MegaNode *node);
     void insertNode(mega::MegaNode *node, int index);
     void removeNode(mega::MegaNode *node);
     void displayFiles(bool enable);
+    //Access level cached by QMegaModel. It's only valid for the same generation
+    bool getCachedAccess(int generation, int *access);
+    void setCachedAccess(int access, int generation);
 
     ~MegaItem();
 
 protected:
+    static bool lessThan(mega::MegaNode *a, mega::MegaNode *b);
+
     bool showFiles;
     MegaItem *parent;
     mega::MegaNode *node;
     mega::MegaNodeList *children;
-    QList<MegaItem *> childItems;
-    QList<mega::MegaNode *> insertedNodes;
+    //Children of the list that can be shown (the list has folders first)
+    int numListChildren;
+    //Next child of the list without an item
+    int nextListChild;
+    QVector<MegaItem *> childItems;
+    QHash<mega::MegaHandle, MegaItem *> childrenByHandle;
+    QHash<mega::MegaHandle, int> listPositions;
+    QHash<mega::MegaHandle, mega::MegaNode *> insertedNodes;
+    int access;
+    int accessGeneration;
 };
 
 #endif // MEGAITEM_H
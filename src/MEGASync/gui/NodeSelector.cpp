@@ -5,6 +5,7 @@
 #include <QPointer>
 #include <QMenu>
 #include "control/Utilities.h"
+#include "MegaApplication.h"
 
 
 using namespace mega;
@@ -78,6 +79,7 @@ void NodeSelector::nodesReady()
 
     ui->tMegaFolders->setModel(model);
     connect(ui->tMegaFolders->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)),this, SLOT(onSelectionChanged(QItemSelection,QItemSelection)));
+    connect((MegaApplication *)qApp, SIGNAL(nodesUpdated()), this, SLOT(onNodesUpdated()), Qt::UniqueConnection);
 
     ui->tMegaFolders->collapseAll();
     ui->tMegaFolders->header()->close();
@@ -136,19 +138,14 @@ void NodeSelector::setSelectedFolderHandle(long long selectedHandle)
     QModelIndex parentModelIndex;
     node = list.at(index);
 
-    for (int i = 0; i < model->rowCount(); i++)
+    QModelIndex tmp = model->findItemByHandle(node->getHandle());
+    if (tmp.isValid())
     {
-        QModelIndex tmp = model->index(i, 0);
-        MegaNode *n = model->getNode(tmp);
-        if (n && n->getHandle() == node->getHandle())
-        {
-            node = NULL;
-            parentModelIndex = modelIndex;
-            modelIndex = tmp;
-            index--;
-            ui->tMegaFolders->expand(parentModelIndex);
-            break;
-        }
+        node = NULL;
+        parentModelIndex = modelIndex;
+        modelIndex = tmp;
+        index--;
+        ui->tMegaFolders->expand(parentModelIndex);
     }
 
     if (node)
@@ -164,19 +161,14 @@ void NodeSelector::setSelectedFolderHandle(long long selectedHandle)
     while (index >= 0)
     {
         node = list.at(index);
-        for (int j = 0; j < model->rowCount(modelIndex); j++)
+        tmp = model->findItemByHandle(node->getHandle(), modelIndex);
+        if (tmp.isValid())
         {
-            QModelIndex tmp = model->index(j, 0, modelIndex);
-            MegaNode *n = model->getNode(tmp);
-            if (n && n->getHandle() == node->getHandle())
-            {
-                node = NULL;
-                parentModelIndex = modelIndex;
-                modelIndex = tmp;
-                index--;
-                ui->tMegaFolders->expand(parentModelIndex);
-                break;
-            }
+            node = NULL;
+            parentModelIndex = modelIndex;
+            modelIndex = tmp;
+            index--;
+            ui->tMegaFolders->expand(parentModelIndex);
         }
 
         if (node)
@@ -330,6 +322,13 @@ void NodeSelector::onSelectionChanged(QItemSelection, QItemSelection)
     }
 }
 
+void NodeSelector::onNodesUpdated()
+{
+    //Shares could have changed, so the access levels are read again
+    model->invalidateAccess();
+    ui->tMegaFolders->viewport()->update();
+}
+
 void NodeSelector::on_bNewFolder_clicked()
 {
     QPointer<QInputDialog> id = new QInputDialog(this);
@@ -370,18 +369,12 @@ void NodeSelector::on_bNewFolder_clicked()
         }
         else
         {
-            for (int i = 0; i < model->rowCount(selectedItem); i++)
+            QModelIndex row = model->findItemByHandle(node->getHandle(), selectedItem);
+            if (row.isValid())
             {
-                QModelIndex row = model->index(i, 0, selectedItem);
-                MegaNode *node = model->getNode(row);
-
-                if (node && text.compare(QString::fromUtf8(node->getName())) == 0)
-                {
-                    setSelectedFolderHandle(node->getHandle());
-                    ui->tMegaFolders->selectionModel()->select(row, QItemSelectionModel::ClearAndSelect);
-                    ui->tMegaFolders->selectionModel()->setCurrentIndex(row, QItemSelectionModel::ClearAndSelect);
-                    break;
-                }
+                setSelectedFolderHandle(node->getHandle());
+                ui->tMegaFolders->selectionModel()->select(row, QItemSelectionModel::ClearAndSelect);
+                ui->tMegaFolders->selectionModel()->setCurrentIndex(row, QItemSelectionModel::ClearAndSelect);
             }
         }
         delete parent;
@@ -53,6 +53,7 @@ protected:
 
 private slots:
     void onSelectionChanged(QItemSelection,QItemSelection);
+    void onNodesUpdated();
     void on_bNewFolder_clicked();
     void on_bOk_clicked();
 };
@@ -2,6 +2,7 @@
 
 #include <QBrush>
 #include "control/Utilities.h"
+#include "control/Preferences.h"
 
 using namespace mega;
 
@@ -30,6 +31,7 @@ QMegaModel::QMegaModel(mega::MegaApi *megaApi, QObject *parent) :
     delete contacts;
 
     this->requiredRights = MegaShare::ACCESS_READ;
+    this->accessGeneration = 0;
     this->displayFiles = false;
     this->disableFolders = false;
 }
@@ -62,11 +64,17 @@ QVariant QMegaModel::data(const QModelIndex &index, int role) const
                 return folderIcon;
             }
 
-            return QIcon(Utilities::getExtensionPixmapSmall(QString::fromUtf8(node->getName())));
+            return Utilities::getExtensionIconSmall(QString::fromUtf8(node->getName()));
         }
         case Qt::ForegroundRole:
         {
-            int access = megaApi->getAccess(item->getNode());
+            //getAccess takes the lock of the SDK, so it isn't called on every repaint
+            int access;
+            if (!item->getCachedAccess(accessGeneration, &access))
+            {
+                access = megaApi->getAccess(item->getNode());
+                item->setCachedAccess(access, accessGeneration);
+            }
             if (access < requiredRights || (disableFolders && item->getNode()->isFolder()))
             {
                 return QVariant(QBrush(QColor(170,170,170, 127)));
@@ -103,14 +111,7 @@ QModelIndex QMegaModel::index(int row, int column, const QModelIndex &parent) co
 
     if (parent.isValid())
     {
-        MegaItem * item = NULL;
-        item = (MegaItem *)parent.internalPointer();
-
-        if (!item->areChildrenSet())
-        {
-            item->setChildren(megaApi->getChildren(item->getNode()));
-        }
-
+        MegaItem *item = (MegaItem *)parent.internalPointer();
         return createIndex(row, column, item->getChild(row));
     }
 
@@ -136,18 +137,103 @@ QModelIndex QMegaModel::parent(const QModelIndex &index) const
 
 int QMegaModel::rowCount(const QModelIndex &parent) const
 {
+    //Only the children already fetched
     if (parent.isValid())
     {
         MegaItem *item = (MegaItem *)parent.internalPointer();
-        if (!item->areChildrenSet())
+        return item->getNumChildren();
+    }
+
+    return inshareItems.size() + 1;
+}
+
+bool QMegaModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!parent.isValid())
+    {
+        return true;
+    }
+
+    //Children aren't requested to the SDK until the item is expanded
+    MegaItem *item = (MegaItem *)parent.internalPointer();
+    if (!item->areChildrenSet())
+    {
+        return item->getNode() && item->getNode()->getType() >= MegaNode::TYPE_FOLDER;
+    }
+    return item->getNumChildren() || item->getNumPendingChildren();
+}
+
+bool QMegaModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!parent.isValid())
+    {
+        return false;
+    }
+
+    MegaItem *item = (MegaItem *)parent.internalPointer();
+    if (!item->areChildrenSet())
+    {
+        return item->getNode() && item->getNode()->getType() >= MegaNode::TYPE_FOLDER;
+    }
+    return item->getNumPendingChildren() > 0;
+}
+
+void QMegaModel::fetchMore(const QModelIndex &parent)
+{
+    if (!parent.isValid())
+    {
+        return;
+    }
+
+    MegaItem *item = (MegaItem *)parent.internalPointer();
+    loadChildren(item);
+
+    int count = qMin(item->getNumPendingChildren(), Preferences::NODE_MODEL_PAGE_SIZE);
+    if (!count)
+    {
+        return;
+    }
+
+    int first = item->getNumChildren();
+    beginInsertRows(parent, first, first + count - 1);
+    item->fetchChildren(count);
+    endInsertRows();
+}
+
+QModelIndex QMegaModel::findItemByHandle(MegaHandle handle, const QModelIndex &parent)
+{
+    if (!parent.isValid())
+    {
+        for (int i = 0; i < rowCount(); i++)
         {
-            item->setChildren(megaApi->getChildren(item->getNode()));
+            QModelIndex top = index(i, 0);
+            MegaNode *node = getNode(top);
+            if (node && node->getHandle() == handle)
+            {
+                return top;
+            }
         }
+        return QModelIndex();
+    }
 
-        return item->getNumChildren();
+    MegaItem *item = (MegaItem *)parent.internalPointer();
+    loadChildren(item);
+
+    MegaItem *child = item->findChild(handle);
+    if (!child && item->getListPosition(handle) >= 0)
+    {
+        while (!child && item->getNumPendingChildren())
+        {
+            fetchMore(parent);
+            child = item->findChild(handle);
+        }
     }
 
-    return inshareItems.size() + 1;
+    if (!child)
+    {
+        return QModelIndex();
+    }
+    return index(item->indexOf(child), 0, parent);
 }
 
 void QMegaModel::setRequiredRights(int requiredRights)
@@ -173,7 +259,23 @@ void QMegaModel::showFiles(bool show)
 QModelIndex QMegaModel::insertNode(MegaNode *node, const QModelIndex &parent)
 {
     MegaItem *item = (MegaItem *)parent.internalPointer();
+    loadChildren(item);
+
+    //The children loaded from the SDK can already include the new node
+    if (item->findChild(node->getHandle()) || item->getListPosition(node->getHandle()) >= 0)
+    {
+        QModelIndex existing = findItemByHandle(node->getHandle(), parent);
+        delete node;
+        return existing;
+    }
+
+    //Inserted nodes must go before the children that haven't been fetched
     int index = item->insertPosition(node);
+    while (index == item->getNumChildren() && item->getNumPendingChildren())
+    {
+        fetchMore(parent);
+        index = item->insertPosition(node);
+    }
 
     beginInsertRows(parent, index, index);
     item->insertNode(node, index);
@@ -197,6 +299,14 @@ void QMegaModel::removeNode(QModelIndex &item)
     endRemoveRows();
 }
 
+void QMegaModel::loadChildren(MegaItem *item) const
+{
+    if (!item->areChildrenSet())
+    {
+        item->setChildren(megaApi->getChildren(item->getNode()));
+    }
+}
+
 MegaNode *QMegaModel::getNode(const QModelIndex &index)
 {
     MegaItem *item = (MegaItem *)index.internalPointer();
@@ -207,6 +317,11 @@ MegaNode *QMegaModel::getNode(const QModelIndex &index)
     return item->getNode();
 }
 
+void QMegaModel::invalidateAccess()
+{
+    accessGeneration++;
+}
+
 QMegaModel::~QMegaModel()
 {
     delete rootItem;
@@ -18,18 +18,28 @@ public:
     virtual QModelIndex index(int row, int column, const QModelIndex & parent = QModelIndex()) const;
     virtual QModelIndex parent(const QModelIndex & index) const;
     virtual int rowCount(const QModelIndex & parent = QModelIndex()) const;
+    virtual bool hasChildren(const QModelIndex & parent = QModelIndex()) const;
+    virtual bool canFetchMore(const QModelIndex & parent) const;
+    virtual void fetchMore(const QModelIndex & parent);
 
     void setRequiredRights(int requiredRights);
     void setDisableFolders(bool option);
     void showFiles(bool show);
+    //Takes the ownership of the node. If it's already a child, its row is returned
     QModelIndex insertNode(mega::MegaNode *node, const QModelIndex &parent);
     void removeNode(QModelIndex &item);
+    //Loads the pages of children needed to find the node
+    QModelIndex findItemByHandle(mega::MegaHandle handle, const QModelIndex &parent = QModelIndex());
 
     mega::MegaNode *getNode(const QModelIndex &index);
+    //Access levels are cached per item until the nodes are updated
+    void invalidateAccess();
 
     virtual ~QMegaModel();
 
 protected:
+    void loadChildren(MegaItem *item) const;
+
     mega::MegaApi *megaApi;
     mega::MegaNode *root;
     MegaItem *rootItem;
@@ -38,6 +48,7 @@ protected:
     QList<mega::MegaNode *> ownNodes;
     QIcon folderIcon;
     int requiredRights;
+    int accessGeneration;
     bool displayFiles;
     bool disableFolders;
 };
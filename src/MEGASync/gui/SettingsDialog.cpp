@@ -5,6 +5,7 @@
 #include <QTranslator>
 #include <QGraphicsDropShadowEffect>
 #include <QMessageBox>
+#include <QMenu>
 
 #if QT_VERSION >= 0x050000
 #include <QtConcurrent/QtConcurrent>
@@ -14,6 +15,7 @@
 #include "SettingsDialog.h"
 #include "ui_SettingsDialog.h"
 #include "control/Utilities.h"
+#include "control/DebrisTracker.h"
 #include "platform/Platform.h"
 
 #ifdef __APPLE__
@@ -31,17 +33,14 @@ using namespace std;
 
 long long calculateCacheSize()
 {
+    //Only the debris folders modified since the last checkpoint are walked
     Preferences *preferences = Preferences::instance();
-    long long cacheSize = 0;
+    QStringList localFolders;
     for (int i = 0; i < preferences->getNumSyncedFolders(); i++)
     {
-        QString syncPath = preferences->getLocalFolder(i);
-        if (!syncPath.isEmpty())
-        {
-            Utilities::getFolderSize(syncPath + QDir::separator() + QString::fromAscii(mega::MEGA_DEBRIS_FOLDER), &cacheSize);
-        }
+        localFolders.append(preferences->getLocalFolder(i));
     }
-    return cacheSize;
+    return DebrisTracker::instance()->refresh(localFolders);
 }
 
 void deleteCache()
@@ -52,7 +51,8 @@ void deleteCache()
         QString syncPath = preferences->getLocalFolder(i);
         if (!syncPath.isEmpty())
         {
-            Utilities::removeRecursively(syncPath + QDir::separator() + QString::fromAscii(mega::MEGA_DEBRIS_FOLDER));
+            Utilities::removeRecursively(DebrisTracker::debrisPath(syncPath));
+            DebrisTracker::instance()->clear(syncPath);
         }
     }
 }
@@ -105,6 +105,8 @@ SettingsDialog::SettingsDialog(MegaApplication *app, bool proxyOnly, QWidget *pa
     ui->eLimit->setValidator(new QDoubleValidator(this));
     ui->bAccount->setChecked(true);
     ui->wStack->setCurrentWidget(ui->pAccount);
+    ui->tSyncs->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->tSyncs, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(onSyncsContextMenu(QPoint)));
 
 #ifndef WIN32
     ui->rProxyAuto->hide();
@@ -914,6 +916,9 @@ void SettingsDialog::loadSettings()
 
         loadSizeLimits();
         ui->cOverlayIcons->setChecked(preferences->overlayIconsDisabled());
+        ui->cDebrisRetention->setText(tr("Remove local debris older than %1 days").arg(Preferences::DEBRIS_RETENTION_DAYS));
+        ui->cDebrisRetention->setChecked(preferences->debrisMaxAgeDays() > 0);
+        ui->cHardLinks->setChecked(preferences->allowHardLinksInSyncs());
     }
 
     if (!proxyTestProgressDialog)
@@ -1147,24 +1152,17 @@ bool SettingsDialog::saveSettings()
                     continue;
                 }
 
-                for (j = 0; j < preferences->getNumSyncedFolders(); j++)
+                j = preferences->getSyncIndexByLocalPath(localFolderPath);
+                if (j >= 0 && !megaFolderPath.compare(preferences->getMegaFolder(j)))
                 {
-                    QString previousLocalPath = preferences->getLocalFolder(j);
-                    QString previousMegaPath = preferences->getMegaFolder(j);
-
-                    if (!megaFolderPath.compare(previousMegaPath) && !localFolderPath.compare(previousLocalPath))
+                    if (enabled && preferences->isFolderActive(j) != enabled)
                     {
-                        if (enabled && preferences->isFolderActive(j) != enabled)
-                        {
-                            preferences->setMegaFolderHandle(j, node->getHandle());
-                            preferences->setSyncState(j, enabled);
-                            megaApi->syncFolder(localFolderPath.toUtf8().constData(), node);
-                        }
-                        break;
+                        preferences->setMegaFolderHandle(j, node->getHandle());
+                        preferences->setSyncState(j, enabled);
+                        megaApi->syncFolder(localFolderPath.toUtf8().constData(), node);
                     }
                 }
-
-                if (j == preferences->getNumSyncedFolders())
+                else
                 {
                     MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromAscii("Adding sync: %1 - %2")
                                  .arg(localFolderPath).arg(megaFolderPath).toUtf8().constData());
@@ -1221,6 +1219,8 @@ bool SettingsDialog::saveSettings()
         app->setUseHttpsOnly(preferences->usingHttpsOnly());
 
         //Advanced
+        ExclusionRules oldExclusionRules = ExclusionRules::fromPreferences(preferences);
+        bool exclusionRulesChanged = excludedNamesChanged || sizeLimitsChanged;
         if (excludedNamesChanged)
         {
             QStringList excludedNames;
@@ -1236,13 +1236,7 @@ bool SettingsDialog::saveSettings()
                 vExclusions.push_back(excludedNames[i].toUtf8().constData());
             }
             megaApi->setExcludedNames(&vExclusions);
-
-            QMessageBox::information(this, tr("Warning"), tr("The new excluded file names will be taken into account\n"
-                                                                            "when the application starts again"), QMessageBox::Ok);
             excludedNamesChanged = false;
-            preferences->setCrashed(true);
-
-            QT_TR_NOOP("Do you want to restart MEGAsync now?");
         }
 
         if (sizeLimitsChanged)
@@ -1271,11 +1265,15 @@ bool SettingsDialog::saveSettings()
             {
                 megaApi->setExclusionUpperSizeLimit(0);
             }
-
-            QMessageBox::information(this, tr("Warning"), tr("The new excluded file sizes will be taken into account when the application starts again."), QMessageBox::Ok);
             sizeLimitsChanged = false;
         }
 
+        //The new rules are applied to the existing syncs without a restart
+        if (exclusionRulesChanged)
+        {
+            app->reevaluateExclusions(oldExclusionRules);
+        }
+
         if (ui->cOverlayIcons->isChecked() != preferences->overlayIconsDisabled())
         {
             preferences->disableOverlayIcons(ui->cOverlayIcons->isChecked());
@@ -1284,6 +1282,18 @@ bool SettingsDialog::saveSettings()
                 Platform::notifyItemChange(preferences->getLocalFolder(i));
             }
         }
+
+        //The local debris is only removed if the user opts in
+        if (ui->cDebrisRetention->isChecked() != (preferences->debrisMaxAgeDays() > 0))
+        {
+            preferences->setDebrisMaxAgeDays(ui->cDebrisRetention->isChecked() ? Preferences::DEBRIS_RETENTION_DAYS : 0);
+        }
+
+        //Hard linked files share their contents with the source, so it's opt-in
+        if (ui->cHardLinks->isChecked() != preferences->allowHardLinksInSyncs())
+        {
+            preferences->setAllowHardLinksInSyncs(ui->cHardLinks->isChecked());
+        }
     }
 
     bool proxyChanged = false;
@@ -2020,11 +2030,74 @@ void SettingsDialog::on_bUpdate_clicked()
 
 void SettingsDialog::on_bFullCheck_clicked()
 {
-    preferences->setCrashed(true);
-    if (QMessageBox::warning(this, tr("Full scan"), tr("MEGAsync will perform a full scan of your synced folders when it starts.\n\nDo you want to restart MEGAsync now?"),
-                         QMessageBox::Yes, QMessageBox::No) == QMessageBox::Yes)
+    if (QMessageBox::warning(this, tr("Full scan"),
+                             tr("MEGAsync will perform a full scan of your synced folders.\n\nDo you want to continue?"),
+                             QMessageBox::Yes, QMessageBox::No) != QMessageBox::Yes)
+    {
+        return;
+    }
+
+    //The syncs are checked again without restarting the application,
+    //with the same limit of concurrent initial scans as in the startup
+    QList<int> syncIds;
+    for (int i = 0; i < preferences->getNumSyncedFolders(); i++)
+    {
+        if (preferences->isFolderActive(i))
+        {
+            syncIds.append(preferences->getSyncId(i));
+        }
+    }
+    app->repairSyncs(syncIds);
+}
+
+void SettingsDialog::onSyncsContextMenu(const QPoint &pos)
+{
+    int row = ui->tSyncs->rowAt(pos.y());
+    if (row < 0 || !ui->tSyncs->item(row, 0))
     {
-        app->rebootApplication(false);
+        return;
+    }
+
+    //Only saved and active syncs can be rescanned
+    int index = preferences->getSyncIndexByLocalPath(ui->tSyncs->item(row, 0)->text());
+    if (index < 0 || !preferences->isFolderActive(index))
+    {
+        return;
+    }
+
+    int syncId = preferences->getSyncId(index);
+    QMenu menu;
+    QAction *rescanAction = menu.addAction(tr("Rescan this sync"));
+    rescanAction->setEnabled(!app->isRescanningSync(syncId));
+    QAction *selectedAction = menu.exec(ui->tSyncs->viewport()->mapToGlobal(pos));
+    if (selectedAction == rescanAction)
+    {
+        app->rescanSync(syncId);
+    }
+}
+
+void SettingsDialog::setSyncRescanStatus(int syncId, QString status)
+{
+    int index = preferences->getSyncIndexById(syncId);
+    if (index < 0)
+    {
+        return;
+    }
+
+    QString localFolder = preferences->getLocalFolder(index);
+    for (int i = 0; i < ui->tSyncs->rowCount(); i++)
+    {
+        QTableWidgetItem *localItem = ui->tSyncs->item(i, 0);
+        if (localItem && localItem->text() == localFolder)
+        {
+            QTableWidgetItem *megaItem = ui->tSyncs->item(i, 1);
+            localItem->setToolTip(status.size() ? status : localItem->text());
+            if (megaItem)
+            {
+                megaItem->setToolTip(status.size() ? status : megaItem->text());
+            }
+            return;
+        }
     }
 }
 
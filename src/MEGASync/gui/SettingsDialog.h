@@ -46,6 +46,7 @@ public:
     void refreshAccountDetails();
     void setUpdateAvailable(bool updateAvailable);
     void openSettingsTab(int tab);
+    void setSyncRescanStatus(int syncId, QString status);
 
 public slots:
     void stateChanged();
@@ -97,6 +98,7 @@ private slots:
     void on_bExportMasterKey_clicked();
 
     void on_tSyncs_doubleClicked(const QModelIndex &index);
+    void onSyncsContextMenu(const QPoint &pos);
     void on_bUploadFolder_clicked();
     void on_bDownloadFolder_clicked();
 
@@ -4,6 +4,7 @@
 #include "MegaApplication.h"
 #include "control/Utilities.h"
 #include "gui/MultiQFileDialog.h"
+#include "gui/SyncSizeReportDialog.h"
 
 using namespace mega;
 
@@ -173,7 +174,7 @@ void SetupWizard::onRequestFinish(MegaApi *, MegaRequest *request, MegaError *er
                                                            "Please, try again. If the problem persists "
                                                            "please contact bug@mega.co.nz"), QMessageBox::Ok);
                 done(QDialog::Rejected);
-                preferences->setCrashed(true);
+                preferences->setNeedsFullReload(true);
                 app->rebootApplication(false);
                 return;
             }
@@ -424,6 +425,11 @@ void SetupWizard::on_bNext_clicked()
             return;
         }
 
+        if (!SyncSizeReportDialog::confirm(app, localFolderPath, this))
+        {
+            return;
+        }
+
         MegaNode *node = megaApi->getNodeByPath(ui->eMegaFolder->text().toUtf8().constData());
         if (!node)
         {
@@ -435,7 +441,7 @@ void SetupWizard::on_bNext_clicked()
                                                            "Please, try again. If the problem persists "
                                                            "please contact bug@mega.co.nz"), QMessageBox::Ok);
                 done(QDialog::Rejected);
-                preferences->setCrashed(true);
+                preferences->setNeedsFullReload(true);
                 app->rebootApplication(false);
                 return;
             }
@@ -487,7 +493,7 @@ void SetupWizard::on_bCancel_clicked()
                                                        "Please, try again. If the problem persists "
                                                        "please contact bug@mega.co.nz"), QMessageBox::Ok);
             done(QDialog::Rejected);
-            preferences->setCrashed(true);
+            preferences->setNeedsFullReload(true);
             app->rebootApplication(false);
             return;
         }
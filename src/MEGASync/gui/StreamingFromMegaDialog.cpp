@@ -4,6 +4,7 @@
 
 #include "platform/Platform.h"
 #include "control/Utilities.h"
+#include "control/PublicNodeCache.h"
 
 #if QT_VERSION >= 0x050000
 #include <QtConcurrent/QtConcurrent>
@@ -127,6 +128,15 @@ void StreamingFromMegaDialog::on_bFromPublicLink_clicked()
     {
         return;
     }
+
+    MegaNode *node = PublicNodeCache::instance()->getNode(text);
+    if (node)
+    {
+        delete selectedMegaNode;
+        selectedMegaNode = node;
+        onLinkInfoAvailable();
+        return;
+    }
     megaApi->getPublicNode(text.toUtf8().constData(), delegateListener);
 }
 
@@ -331,6 +341,7 @@ void StreamingFromMegaDialog::onRequestFinish(MegaApi *api, MegaRequest *request
                 delete selectedMegaNode;
             }
             selectedMegaNode = request->getPublicMegaNode();
+            PublicNodeCache::instance()->addNode(QString::fromUtf8(request->getLink()), selectedMegaNode);
             onLinkInfoAvailable();
         }
         break;
@@ -0,0 +1,84 @@
+#include "SyncSizeReportDialog.h"
+#include "MegaApplication.h"
+#include "control/Utilities.h"
+#include <QProgressDialog>
+#include <QMessageBox>
+
+bool SyncSizeReportDialog::confirm(MegaApplication *app, QString localFolder, QWidget *parent)
+{
+    Preferences *preferences = Preferences::instance();
+
+    //The scan runs in the global thread pool while the dialog is shown
+    SyncSizeEstimator estimator;
+    QProgressDialog progress(tr("Analyzing the local folder..."), tr("Skip"), 0, 0, parent);
+    progress.setWindowModality(Qt::WindowModal);
+    QObject::connect(&estimator, SIGNAL(estimateFinished(SyncSizeReport)), &progress, SLOT(accept()));
+    //The setup wizard runs before the exclusion settings are available
+    ExclusionRules rules = preferences->logged() ? ExclusionRules::fromPreferences(preferences) : ExclusionRules();
+    estimator.estimate(localFolder, rules);
+    if (progress.exec() != QDialog::Accepted)
+    {
+        estimator.cancel();
+        return true;
+    }
+
+    SyncSizeReport report = estimator.getReport();
+    if (report.cancelled || !report.numFiles)
+    {
+        return true;
+    }
+
+    long long availableStorage = -1;
+    if (preferences->logged() && preferences->totalStorage())
+    {
+        availableStorage = qMax(0LL, preferences->totalStorage() - preferences->usedStorage());
+    }
+
+    return QMessageBox::question(parent, tr("Sync folder"),
+                                 getReportText(report, availableStorage, app->getUploadRate()),
+                                 QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes) == QMessageBox::Yes;
+}
+
+QString SyncSizeReportDialog::getReportText(const SyncSizeReport &report, long long availableStorage, long long bytesPerSecond)
+{
+    QString text = tr("This folder contains %1 files and %2 folders (%3)")
+            .arg(report.numFiles).arg(report.numFolders).arg(Utilities::getSizeString(report.totalBytes));
+
+    if (report.excludedFiles)
+    {
+        text += QString::fromUtf8("\n") + tr("%1 files (%2) will be skipped by your exclusion settings")
+                .arg(report.excludedFiles).arg(Utilities::getSizeString(report.excludedBytes));
+    }
+
+    if (!report.biggestFolders.isEmpty())
+    {
+        text += QString::fromUtf8("\n\n") + tr("Biggest folders:");
+        for (int i = 0; i < report.biggestFolders.size(); i++)
+        {
+            text += QString::fromUtf8("\n    %1: %2").arg(report.biggestFolders[i].first)
+                    .arg(Utilities::getSizeString(report.biggestFolders[i].second));
+        }
+    }
+
+    long long syncedBytes = report.totalBytes - report.excludedBytes;
+    if (availableStorage >= 0)
+    {
+        text += QString::fromUtf8("\n\n") + tr("Available space in your account: %1").arg(Utilities::getSizeString(availableStorage));
+        if (syncedBytes > availableStorage)
+        {
+            text += QString::fromUtf8("\n") + tr("This folder doesn't fit in your account");
+        }
+    }
+
+    long long seconds = SyncSizeEstimator::estimateUploadTime(report, bytesPerSecond);
+    if (seconds >= 0)
+    {
+        QString time = (seconds >= 86400) ? tr("%n day(s)", 0, (int)(seconds / 86400))
+                                          : Utilities::getRemainingTimeString(seconds);
+        text += QString::fromUtf8("\n") + tr("Estimated time to upload it: %1 (at %2/s)")
+                .arg(time).arg(Utilities::getSizeString(bytesPerSecond));
+    }
+
+    text += QString::fromUtf8("\n\n") + tr("Do you want to sync this folder?");
+    return text;
+}
@@ -0,0 +1,27 @@
+#ifndef SYNCSIZEREPORTDIALOG_H
+#define SYNCSIZEREPORTDIALOG_H
+
+#include <QCoreApplication>
+#include <QWidget>
+#include <QString>
+#include "control/SyncSizeEstimator.h"
+
+class MegaApplication;
+
+//Scans a local folder before it's synced and asks the user for confirmation,
+//showing its size, what the exclusion settings would skip, the biggest folders,
+//the available storage and the estimated time for the first full sync
+class SyncSizeReportDialog
+{
+    Q_DECLARE_TR_FUNCTIONS(SyncSizeReportDialog)
+
+public:
+    //Returns false if the user doesn't want to sync the folder.
+    //If the user skips the scan, the folder is accepted
+    static bool confirm(MegaApplication *app, QString localFolder, QWidget *parent = 0);
+
+protected:
+    static QString getReportText(const SyncSizeReport &report, long long availableStorage, long long bytesPerSecond);
+};
+
+#endif // SYNCSIZEREPORTDIALOG_H
@@ -31,7 +31,8 @@ SOURCES += $$PWD/SettingsDialog.cpp \
     $$PWD/ConfirmSSLexception.cpp \
     $$PWD/UpgradeDialog.cpp \
     $$PWD/PlanWidget.cpp \
-    $$PWD/InfoWizard.cpp
+    $$PWD/InfoWizard.cpp \
+    $$PWD/SyncSizeReportDialog.cpp
 
 HEADERS  += $$PWD/SettingsDialog.h \
     $$PWD/ActiveTransfer.h \
@@ -64,7 +65,8 @@ HEADERS  += $$PWD/SettingsDialog.h \
     $$PWD/ConfirmSSLexception.h \
     $$PWD/UpgradeDialog.h \
     $$PWD/PlanWidget.h \
-    $$PWD/InfoWizard.h
+    $$PWD/InfoWizard.h \
+    $$PWD/SyncSizeReportDialog.h
 
 INCLUDEPATH += $$PWD
 
@@ -0,0 +1,173 @@
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include "FileSystemWalker.h"
+
+//Entries of the synthetic tree. It can be changed with MEGA_WALKER_BENCHMARK_ENTRIES
+static const long long DEFAULT_NUM_ENTRIES = 1000000;
+static const int FILES_PER_FOLDER = 999;
+static const int FOLDERS_PER_GROUP = 100;
+
+//Walks of a synthetic tree (FOLDERS_PER_GROUP folders per group folder, FILES_PER_FOLDER
+//small files per folder) with the recursive QDir::entryInfoList used by Utilities
+//before FileSystemWalker, and with FileSystemWalker
+class FileSystemWalkerBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString rootPath;
+    long long numFiles;
+    long long numFolders;
+    long long totalSize;
+
+    //Previous Utilities::getFolderSize
+    static void legacyFolderSize(QString folderPath, long long *size)
+    {
+        QDir dir(folderPath);
+        QFileInfoList entries = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
+        for (int i = 0; i < entries.size(); i++)
+        {
+            QFileInfo info = entries[i];
+            if (info.isFile())
+            {
+                (*size) += info.size();
+            }
+            else if (info.isDir())
+            {
+                legacyFolderSize(info.absoluteFilePath(), size);
+            }
+        }
+    }
+
+    //Previous Utilities::countFilesAndFolders, without the limits and the event processing
+    static void legacyCountFilesAndFolders(QString path, long long *files, long long *folders)
+    {
+        QDir dir(path);
+        QFileInfoList entries = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot);
+        for (int i = 0; i < entries.size(); i++)
+        {
+            QFileInfo info = entries[i];
+            if (info.isFile())
+            {
+                (*files)++;
+            }
+            else if (info.isDir())
+            {
+                legacyCountFilesAndFolders(info.absoluteFilePath(), files, folders);
+                (*folders)++;
+            }
+        }
+    }
+
+    static void removeTree(QString path)
+    {
+        QDir dir(path);
+        QFileInfoList entries = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
+        for (int i = 0; i < entries.size(); i++)
+        {
+            if (entries[i].isDir())
+            {
+                removeTree(entries[i].absoluteFilePath());
+            }
+            else
+            {
+                dir.remove(entries[i].fileName());
+            }
+        }
+        QDir().rmdir(path);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        long long numEntries = qgetenv("MEGA_WALKER_BENCHMARK_ENTRIES").toLongLong();
+        if (numEntries <= 0)
+        {
+            numEntries = DEFAULT_NUM_ENTRIES;
+        }
+
+        rootPath = QDir::tempPath() + QString::fromAscii("/FileSystemWalkerBenchmark-%1").arg(QCoreApplication::applicationPid());
+        numFiles = 0;
+        numFolders = 0;
+        totalSize = 0;
+
+        QByteArray contents(16, 'x');
+        for (int group = 0; (numFiles + numFolders) < numEntries; group++)
+        {
+            QString groupPath = rootPath + QString::fromAscii("/group%1").arg(group);
+            QVERIFY(QDir().mkpath(groupPath));
+            numFolders++;
+
+            for (int folder = 0; folder < FOLDERS_PER_GROUP && (numFiles + numFolders) < numEntries; folder++)
+            {
+                QString folderPath = groupPath + QString::fromAscii("/folder%1").arg(folder);
+                QVERIFY(QDir().mkdir(folderPath));
+                numFolders++;
+
+                for (int file = 0; file < FILES_PER_FOLDER && (numFiles + numFolders) < numEntries; file++)
+                {
+                    QFile f(folderPath + QString::fromAscii("/file%1.txt").arg(file));
+                    QVERIFY(f.open(QIODevice::WriteOnly));
+                    f.write(contents);
+                    f.close();
+                    numFiles++;
+                    totalSize += contents.size();
+                }
+            }
+        }
+    }
+
+    void cleanupTestCase()
+    {
+        removeTree(rootPath);
+    }
+
+    void legacySize()
+    {
+        QBENCHMARK
+        {
+            long long size = 0;
+            legacyFolderSize(rootPath, &size);
+            QCOMPARE(size, totalSize);
+        }
+    }
+
+    void walkerSize()
+    {
+        QBENCHMARK
+        {
+            FileSystemWalker walker(FileSystemWalker::WALK_SIZES);
+            QVERIFY(walker.walk(rootPath));
+            QCOMPARE(walker.getTotalSize(), totalSize);
+        }
+    }
+
+    void legacyCount()
+    {
+        QBENCHMARK
+        {
+            long long files = 0;
+            long long folders = 0;
+            legacyCountFilesAndFolders(rootPath, &files, &folders);
+            QCOMPARE(files, numFiles);
+            QCOMPARE(folders, numFolders);
+        }
+    }
+
+    void walkerCount()
+    {
+        QBENCHMARK
+        {
+            FileSystemWalker walker;
+            QVERIFY(walker.walk(rootPath));
+            QCOMPARE(walker.getNumFiles(), numFiles);
+            QCOMPARE(walker.getNumFolders(), numFolders);
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(FileSystemWalkerBenchmark)
+
+#include "FileSystemWalkerBenchmark.moc"
@@ -0,0 +1,17 @@
+TARGET = FileSystemWalkerBenchmark
+TEMPLATE = app
+#Benchmarks aren't run by make check, they create a large tree in the temporary folder
+CONFIG += console
+CONFIG -= app_bundle
+
+QT += testlib
+QT -= gui
+
+DEFINES += QT_NO_CAST_FROM_ASCII QT_NO_CAST_TO_ASCII
+
+INCLUDEPATH += $$PWD/../../MEGASync/control
+
+SOURCES += FileSystemWalkerBenchmark.cpp \
+    ../../MEGASync/control/FileSystemWalker.cpp
+
+HEADERS += ../../MEGASync/control/FileSystemWalker.h
@@ -0,0 +1,243 @@
+#include <QtTest>
+#include <QSettings>
+#include <QCryptographicHash>
+#include "EncryptedSettings.h"
+#include "platform/Platform.h"
+
+static const int NUM_SYNCS = 200;
+
+//Keys of a sync in Preferences
+static const char *SYNC_KEYS[] = {"syncName", "localFolder", "megaFolder", "megaFolderHandle",
+                                  "localFingerprint", "enabled", "temporaryInactive", "exclusionRules"};
+static const int NUM_SYNC_KEYS = sizeof(SYNC_KEYS) / sizeof(SYNC_KEYS[0]);
+
+//EncryptedSettings before the key hashes were memoized and the values were kept in memory:
+//every access hashes the key and encrypts or decrypts the value of the INI file
+class LegacySettings : protected QSettings
+{
+public:
+    explicit LegacySettings(QString file) : QSettings(file, QSettings::IniFormat)
+    {
+        QByteArray fixedSeed("$JY/X?o=h·&%v/M(");
+        encryptionKey = QCryptographicHash::hash(XOR(fixedSeed, Platform::getLocalStorageKey()),
+                                                 QCryptographicHash::Sha1);
+    }
+
+    void setValue(const QString &key, const QVariant &value)
+    {
+        QSettings::setValue(hash(key), encrypt(key, value.toString()));
+    }
+
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant())
+    {
+        return QVariant(decrypt(key, QSettings::value(hash(key), encrypt(key, defaultValue.toString())).toString()));
+    }
+
+    void beginGroup(const QString &prefix)
+    {
+        QSettings::beginGroup(hash(prefix));
+    }
+
+    void endGroup()
+    {
+        QSettings::endGroup();
+    }
+
+    void sync()
+    {
+        QSettings::sync();
+    }
+
+protected:
+    QByteArray XOR(const QByteArray &key, const QByteArray &data) const
+    {
+        int keyLen = key.length();
+        if (!keyLen)
+        {
+            return data;
+        }
+
+        QByteArray result;
+        int rotation = abs(key[keyLen/3]*key[keyLen/5])%keyLen;
+        int increment = abs(key[keyLen/2]*key[keyLen/7])%keyLen;
+        for (int i = 0, j = rotation; i < data.length(); i++, j -= increment)
+        {
+            if (j < 0)
+            {
+                j += keyLen;
+            }
+            result.append(data[i] ^ key[j]);
+        }
+        return result;
+    }
+
+    QString encrypt(const QString key, const QString value) const
+    {
+        if (value.isEmpty())
+        {
+            return value;
+        }
+
+        QByteArray k = hash(key).toAscii();
+        QByteArray xValue = XOR(k, value.toUtf8());
+        QByteArray xKey = XOR(k, group().toAscii());
+        QByteArray xEncrypted = XOR(k, Platform::encrypt(xValue, xKey));
+        return QString::fromAscii(xEncrypted.toBase64());
+    }
+
+    QString decrypt(const QString key, const QString value) const
+    {
+        if (value.isEmpty())
+        {
+            return value;
+        }
+
+        QByteArray k = hash(key).toAscii();
+        QByteArray xValue = XOR(k, QByteArray::fromBase64(value.toAscii()));
+        QByteArray xKey = XOR(k, group().toAscii());
+        QByteArray xDecrypted = XOR(k, Platform::decrypt(xValue, xKey));
+        return QString::fromUtf8(xDecrypted);
+    }
+
+    QString hash(const QString key) const
+    {
+        QByteArray xPath = XOR(encryptionKey, (key+group()).toUtf8());
+        QByteArray keyHash = QCryptographicHash::hash(xPath, QCryptographicHash::Sha1);
+        QByteArray xKeyHash = XOR(key.toUtf8(), keyHash);
+        return QString::fromAscii(xKeyHash.toHex());
+    }
+
+    QByteArray encryptionKey;
+};
+
+//value()/setValue() of all the keys of NUM_SYNCS syncs, as Preferences does when it loads
+//or saves the syncs, with the previous implementation and with the current one
+class SettingsBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString dataPath;
+
+    QString settingsFile(QString name)
+    {
+        return dataPath + QString::fromAscii("/") + name;
+    }
+
+    template<class T> static void writeSyncs(T &settings)
+    {
+        settings.beginGroup(QString::fromAscii("syncs"));
+        for (int i = 0; i < NUM_SYNCS; i++)
+        {
+            settings.beginGroup(QString::number(i));
+            for (int j = 0; j < NUM_SYNC_KEYS; j++)
+            {
+                settings.setValue(QString::fromAscii(SYNC_KEYS[j]),
+                                  QString::fromAscii("/home/user/MEGA/sync %1/%2").arg(i).arg(j));
+            }
+            settings.endGroup();
+        }
+        settings.endGroup();
+    }
+
+    template<class T> static int readSyncs(T &settings)
+    {
+        int size = 0;
+        settings.beginGroup(QString::fromAscii("syncs"));
+        for (int i = 0; i < NUM_SYNCS; i++)
+        {
+            settings.beginGroup(QString::number(i));
+            for (int j = 0; j < NUM_SYNC_KEYS; j++)
+            {
+                size += settings.value(QString::fromAscii(SYNC_KEYS[j])).toString().size();
+            }
+            settings.endGroup();
+        }
+        settings.endGroup();
+        return size;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        dataPath = QDir::tempPath() + QString::fromAscii("/SettingsBenchmark-%1").arg(QCoreApplication::applicationPid());
+        QDir().mkpath(dataPath);
+    }
+
+    void cleanupTestCase()
+    {
+        QDir dir(dataPath);
+        QStringList files = dir.entryList(QDir::Files);
+        for (int i = 0; i < files.size(); i++)
+        {
+            dir.remove(files.at(i));
+        }
+        QDir().rmdir(dataPath);
+    }
+
+    void legacyValue()
+    {
+        LegacySettings settings(settingsFile(QString::fromAscii("legacy.cfg")));
+        writeSyncs(settings);
+        QBENCHMARK
+        {
+            QCOMPARE(readSyncs(settings) > 0, true);
+        }
+    }
+
+    void legacySetValue()
+    {
+        LegacySettings settings(settingsFile(QString::fromAscii("legacy.cfg")));
+        QBENCHMARK
+        {
+            writeSyncs(settings);
+        }
+    }
+
+    void value()
+    {
+        EncryptedSettings settings(settingsFile(QString::fromAscii("current.cfg")));
+        writeSyncs(settings);
+        QBENCHMARK
+        {
+            QCOMPARE(readSyncs(settings) > 0, true);
+        }
+    }
+
+    void setValue()
+    {
+        EncryptedSettings settings(settingsFile(QString::fromAscii("current.cfg")));
+        QBENCHMARK
+        {
+            writeSyncs(settings);
+        }
+    }
+
+    void load_data()
+    {
+        QTest::addColumn<int>("format");
+        QTest::newRow("ini") << (int)EncryptedSettings::FORMAT_INI;
+        QTest::newRow("blob") << (int)EncryptedSettings::FORMAT_BLOB;
+    }
+
+    void load()
+    {
+        QFETCH(int, format);
+        QString file = settingsFile(QString::fromAscii("load%1.cfg").arg(format));
+        {
+            EncryptedSettings settings(file, format);
+            writeSyncs(settings);
+            settings.sync();
+        }
+
+        QBENCHMARK
+        {
+            EncryptedSettings settings(file, format);
+            QCOMPARE(readSyncs(settings) > 0, true);
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(SettingsBenchmark)
+
+#include "SettingsBenchmark.moc"
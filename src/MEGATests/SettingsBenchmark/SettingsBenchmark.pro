@@ -0,0 +1,22 @@
+TARGET = SettingsBenchmark
+TEMPLATE = app
+#Benchmarks aren't run by make check
+CONFIG += console
+CONFIG -= app_bundle
+
+QT += testlib
+QT -= gui
+
+#The SDK is linked like in MEGAsync
+CONFIG += USE_MEGAAPI
+include(../../MEGASync/mega/bindings/qt/sdk.pri)
+
+DEFINES += QT_NO_CAST_FROM_ASCII QT_NO_CAST_TO_ASCII
+
+#The replacement of platform/Platform.h must be found before the one of MEGAsync
+INCLUDEPATH += $$PWD $$PWD/../../MEGASync/control
+
+SOURCES += SettingsBenchmark.cpp \
+    ../../MEGASync/control/EncryptedSettings.cpp
+
+HEADERS += ../../MEGASync/control/EncryptedSettings.h
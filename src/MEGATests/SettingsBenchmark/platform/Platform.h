@@ -0,0 +1,16 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <QByteArray>
+
+//Replacement of the platform layer for the benchmark.
+//It behaves like LinuxPlatform, so the results measure EncryptedSettings itself
+class Platform
+{
+public:
+    static QByteArray encrypt(QByteArray data, QByteArray) { return data; }
+    static QByteArray decrypt(QByteArray data, QByteArray) { return data; }
+    static QByteArray getLocalStorageKey() { return QByteArray(128, 0); }
+};
+
+#endif // PLATFORM_H
@@ -0,0 +1,162 @@
+#include <QtTest>
+#include "TransferEstimator.h"
+
+//Synthetic progress traces for TransferEstimator.
+//Samples are added every 500 ms unless the test needs something else
+class TransferEstimatorTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    //Adds samples at a constant rate (bytes per second) from "start" during "duration" ms.
+    //Returns the transferred bytes at the end
+    static long long addTrace(TransferEstimator &estimator, long long start, long long duration,
+                              long long initialBytes, long long bytesPerSecond, long long interval = 500)
+    {
+        long long bytes = initialBytes;
+        for (long long t = 0; t <= duration; t += interval)
+        {
+            bytes = initialBytes + bytesPerSecond * t / 1000;
+            estimator.addSample(start + t, bytes);
+        }
+        return bytes;
+    }
+
+    //Adds a transfer at 1 MB/s during 5 s
+    static void addTraceTo(TransferEstimatorMap &estimators, int tag)
+    {
+        for (long long t = 0; t <= 5000; t += 500)
+        {
+            estimators.addSample(tag, t, t * 1000, 10000000);
+        }
+    }
+
+private slots:
+    void unknownRate()
+    {
+        TransferEstimator estimator;
+        QCOMPARE(estimator.getRate(0), 0.0);
+        QCOMPARE(estimator.getRemainingSeconds(1000, 0), -1LL);
+
+        estimator.addSample(1000, 0);
+        QCOMPARE(estimator.getRate(1000), 0.0);
+        QCOMPARE(estimator.getRemainingSeconds(1000, 1000), -1LL);
+    }
+
+    void nothingRemaining()
+    {
+        TransferEstimator estimator;
+        QCOMPARE(estimator.getRemainingSeconds(0, 0), 0LL);
+    }
+
+    void constantRate()
+    {
+        TransferEstimator estimator;
+        addTrace(estimator, 0, 20000, 0, 1000000);
+        QCOMPARE(estimator.getRate(20000), 1000000.0);
+        QCOMPARE(estimator.getRemainingSeconds(10000000, 20000), 10LL);
+    }
+
+    void frequentSamples()
+    {
+        //Samples closer than MIN_SAMPLE_INTERVAL_MS don't change the result
+        TransferEstimator estimator;
+        addTrace(estimator, 0, 20000, 0, 1000000, 50);
+        QCOMPARE(estimator.getRate(20000), 1000000.0);
+    }
+
+    void rateChange()
+    {
+        TransferEstimator estimator;
+        long long bytes = addTrace(estimator, 0, 10000, 0, 1000000);
+
+        //The smoothed rate doesn't jump with a single fast sample
+        estimator.addSample(10500, bytes + 2000000);
+        double rate = estimator.getRate(10500);
+        QVERIFY(rate > 1000000.0);
+        QVERIFY(rate < 1100000.0);
+
+        //But it converges to the new rate
+        addTrace(estimator, 11000, 60000, bytes + 3000000, 2000000);
+        QVERIFY(qAbs(estimator.getRate(71000) - 2000000.0) < 20000.0);
+    }
+
+    void stall()
+    {
+        TransferEstimator estimator;
+        addTrace(estimator, 0, 5000, 0, 1000000);
+        QCOMPARE(estimator.getRate(5000 + TransferEstimator::STALL_TIMEOUT_MS), 1000000.0);
+        QCOMPARE(estimator.getRate(5001 + TransferEstimator::STALL_TIMEOUT_MS), 0.0);
+        QCOMPARE(estimator.getRemainingSeconds(1000, 5001 + TransferEstimator::STALL_TIMEOUT_MS), -1LL);
+    }
+
+    void pauseAndResume()
+    {
+        //The pause doesn't count for the rate and the previous rate is kept
+        TransferEstimator estimator;
+        long long bytes = addTrace(estimator, 0, 5000, 0, 1000000);
+        estimator.addSample(60000, bytes);
+        QCOMPARE(estimator.getRate(60000), 1000000.0);
+
+        addTrace(estimator, 60500, 5000, bytes + 500000, 1000000);
+        QCOMPARE(estimator.getRate(65500), 1000000.0);
+    }
+
+    void retry()
+    {
+        //The transferred bytes go backwards, the window starts again
+        TransferEstimator estimator;
+        addTrace(estimator, 0, 5000, 0, 1000000);
+        estimator.addSample(5500, 0);
+        QCOMPARE(estimator.getRate(5500), 1000000.0);
+
+        addTrace(estimator, 6000, 5000, 500000, 1000000);
+        QCOMPARE(estimator.getRate(11000), 1000000.0);
+        QCOMPARE(estimator.getRemainingSeconds(3000000, 11000), 3LL);
+    }
+
+    void reset()
+    {
+        TransferEstimator estimator;
+        addTrace(estimator, 0, 5000, 0, 1000000);
+        estimator.reset();
+        QCOMPARE(estimator.getRate(5000), 0.0);
+        QCOMPARE(estimator.getRemainingSeconds(1000, 5000), -1LL);
+    }
+
+    void perTransfer()
+    {
+        //Each transfer has its own rate and remaining time
+        TransferEstimatorMap estimators;
+        for (long long t = 0; t <= 10000; t += 500)
+        {
+            estimators.addSample(1, t, t * 1000, 20000000);
+            estimators.addSample(2, t, t * 2000, 100000000);
+        }
+
+        QCOMPARE(estimators.getRate(1, 10000), 1000000.0);
+        QCOMPARE(estimators.getRemainingSeconds(1, 10000), 10LL);
+        QCOMPARE(estimators.getRate(2, 10000), 2000000.0);
+        QCOMPARE(estimators.getRemainingSeconds(2, 10000), 40LL);
+    }
+
+    void unknownTransfer()
+    {
+        TransferEstimatorMap estimators;
+        QCOMPARE(estimators.getRate(1, 0), 0.0);
+        QCOMPARE(estimators.getRemainingSeconds(1, 0), -1LL);
+
+        addTraceTo(estimators, 1);
+        estimators.remove(1);
+        QCOMPARE(estimators.getRate(1, 5000), 0.0);
+        QCOMPARE(estimators.getRemainingSeconds(1, 5000), -1LL);
+
+        addTraceTo(estimators, 2);
+        estimators.clear();
+        QCOMPARE(estimators.getRemainingSeconds(2, 5000), -1LL);
+    }
+};
+
+QTEST_APPLESS_MAIN(TransferEstimatorTest)
+
+#include "TransferEstimatorTest.moc"
@@ -0,0 +1,14 @@
+TARGET = TransferEstimatorTest
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+QT += testlib
+QT -= gui
+
+INCLUDEPATH += $$PWD/../../MEGASync/control
+
+SOURCES += TransferEstimatorTest.cpp \
+    ../../MEGASync/control/TransferEstimator.cpp
+
+HEADERS += ../../MEGASync/control/TransferEstimator.h